@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <xlnt/xlnt.hpp>
+
+double current_time()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Load a workbook once, then time how long it takes to save it at each
+// compression level, how large the result is and how fast the uncompressed
+// parts were written. Run from the repository root
+// or pass the path of the workbook to use.
+void compression(const xlnt::workbook &source, xlnt::compression_level level, const std::string &name)
+{
+    const int repeat = 3;
+    double best = std::numeric_limits<double>::max();
+    std::vector<std::uint8_t> bytes;
+
+    for (int i = 0; i < repeat; i++)
+    {
+        xlnt::workbook wb(source);
+        wb.set_compression_level(level);
+
+        auto start = current_time();
+        wb.save(bytes);
+        best = std::min(current_time() - start, best);
+    }
+
+    std::size_t uncompressed = 0;
+
+    for (const auto &info : xlnt::zip_file(bytes).infolist())
+    {
+        uncompressed += info.file_size;
+    }
+
+    std::cout << name << ": " << best << " ms, " << bytes.size() / 1024 << " KiB, "
+              << uncompressed / 1000000.0 / (best / 1000) << " MB/s" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename = argc > 1 ? argv[1] : "benchmarks/files/large.xlsx";
+
+    xlnt::workbook wb;
+    wb.load(filename);
+
+    compression(wb, xlnt::compression_level::store, "store");
+    compression(wb, xlnt::compression_level::fast, "fast");
+    compression(wb, xlnt::compression_level::normal, "normal");
+    compression(wb, xlnt::compression_level::best, "best");
+
+    return 0;
+}
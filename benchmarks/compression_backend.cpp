@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <xlnt/xlnt.hpp>
+
+double current_time()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Time the zip operations which go through the compression backend xlnt was
+// built with on the members of a workbook, without parsing or serializing any
+// XML. Build xlnt once per COMPRESSION_BACKEND and run this against each build
+// to compare them. Run from the repository root or pass the path of the
+// workbook to use.
+template <typename Operation>
+void measure(const std::string &name, Operation operation)
+{
+    const int repeat = 5;
+    double best = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < repeat; i++)
+    {
+        auto start = current_time();
+        operation();
+        best = std::min(current_time() - start, best);
+    }
+
+    std::cout << name << ": " << best << " ms" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename = argc > 1 ? argv[1] : "benchmarks/files/large.xlsx";
+
+    xlnt::zip_file source(filename);
+    auto members = source.infolist();
+    std::vector<std::string> contents;
+    std::size_t total_size = 0;
+
+    for (const auto &member : members)
+    {
+        contents.push_back(source.read(member));
+        total_size += contents.back().size();
+    }
+
+    std::cout << "backend: " << xlnt::zip_file::get_compression_backend() << ", " << members.size() << " members, "
+              << total_size / 1024 << " KiB uncompressed" << std::endl;
+
+    measure("inflate", [&]() {
+        for (const auto &member : members)
+        {
+            source.read(member);
+        }
+    });
+
+    measure("crc32", [&]() { source.testzip(); });
+
+    for (auto level : { xlnt::compression_level::fast, xlnt::compression_level::normal, xlnt::compression_level::best })
+    {
+        std::vector<std::uint8_t> bytes;
+
+        auto name = level == xlnt::compression_level::fast
+            ? "deflate fast"
+            : level == xlnt::compression_level::normal ? "deflate normal" : "deflate best";
+
+        measure(name, [&]() {
+            xlnt::zip_file archive;
+            archive.set_compression_level(level);
+
+            for (std::size_t i = 0; i < members.size(); i++)
+            {
+                archive.writestr(members[i].filename, contents[i]);
+            }
+
+            archive.save(bytes);
+        });
+
+        std::cout << "    " << bytes.size() / 1024 << " KiB" << std::endl;
+    }
+
+    return 0;
+}
@@ -75,7 +75,8 @@ xlnt::workbook optimized_workbook(const std::vector<xlnt::style> &styles, int n)
     for(int i = 1; i < n; i++)
     {
         auto style = *random_choice(styles.begin(), styles.end());
-        worksheet.append({{0, style}});
+        worksheet.append(std::vector<int>{0});
+        worksheet.get_cell(xlnt::cell_reference(1, worksheet.get_next_row() - 1)).set_style(style);
     }
 
     return wb;
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <xlnt/xlnt.hpp>
+
+double current_time()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Write a sheet with the given number of columns and rows, then time how long
+// it takes to load it again. Reading used to be quadratic in the width of each
+// row, so time per cell should stay roughly flat as the column count grows.
+void wide_sheet(int cols, int rows)
+{
+    const std::string filename = "wide_sheet.xlsx";
+
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        std::vector<int> row;
+
+        for (int i = 0; i < cols; i++)
+        {
+            row.push_back(i);
+        }
+
+        for (int index = 0; index < rows; index++)
+        {
+            ws.append(row);
+        }
+
+        wb.save(filename);
+    }
+
+    const int repeat = 3;
+    double best = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < repeat; i++)
+    {
+        auto start = current_time();
+
+        xlnt::workbook wb;
+        wb.load(filename);
+
+        best = std::min(current_time() - start, best);
+    }
+
+    std::remove(filename.c_str());
+
+    auto cells = static_cast<double>(cols) * rows;
+    std::cout << cols << " cols " << rows << " rows: " << best << " ms, "
+              << best * 1000000.0 / cells << " ns/cell" << std::endl;
+}
+
+int main()
+{
+    wide_sheet(100, 100);
+    wide_sheet(1000, 100);
+    wide_sheet(4000, 100);
+    wide_sheet(16384, 10);
+    wide_sheet(16384, 100);
+
+    return 0;
+}
@@ -66,9 +66,57 @@ SET(MINIZ ../third-party/miniz/miniz.c ../third-party/miniz/miniz.h)
 
 SET(PUGIXML ../third-party/pugixml/src/pugixml.hpp ../third-party/pugixml/src/pugixml.cpp ../third-party/pugixml/src/pugiconfig.hpp)
 
+# worksheets can be loaded on several threads
+find_package(Threads REQUIRED)
+
+# zip members are deflated and inflated with libdeflate or zlib-ng when one of
+# them is found, otherwise with the bundled miniz
+set(COMPRESSION_BACKEND "auto" CACHE STRING "Library used to compress zip members: auto, libdeflate, zlib-ng or miniz")
+set_property(CACHE COMPRESSION_BACKEND PROPERTY STRINGS auto libdeflate zlib-ng miniz)
+
+if(COMPRESSION_BACKEND STREQUAL "auto" OR COMPRESSION_BACKEND STREQUAL "libdeflate")
+    find_path(LIBDEFLATE_INCLUDE_DIR libdeflate.h)
+    find_library(LIBDEFLATE_LIBRARY NAMES deflate libdeflate)
+    if(LIBDEFLATE_INCLUDE_DIR AND LIBDEFLATE_LIBRARY)
+        set(USE_LIBDEFLATE ON)
+    endif()
+endif()
+
+if(COMPRESSION_BACKEND STREQUAL "auto" OR COMPRESSION_BACKEND STREQUAL "zlib-ng")
+    find_path(ZLIB_NG_INCLUDE_DIR zlib-ng.h)
+    find_library(ZLIB_NG_LIBRARY NAMES z-ng zlib-ng)
+    if(ZLIB_NG_INCLUDE_DIR AND ZLIB_NG_LIBRARY)
+        set(USE_ZLIB_NG ON)
+    endif()
+endif()
+
+if(USE_LIBDEFLATE)
+    set(COMPRESSION_DEFINITION XLNT_LIBDEFLATE=1)
+    set(COMPRESSION_INCLUDE_DIR ${LIBDEFLATE_INCLUDE_DIR})
+    set(COMPRESSION_LIBRARY ${LIBDEFLATE_LIBRARY})
+    message(STATUS "Compressing zip members with libdeflate")
+elseif(USE_ZLIB_NG)
+    set(COMPRESSION_DEFINITION XLNT_ZLIB_NG=1)
+    set(COMPRESSION_INCLUDE_DIR ${ZLIB_NG_INCLUDE_DIR})
+    set(COMPRESSION_LIBRARY ${ZLIB_NG_LIBRARY})
+    message(STATUS "Compressing zip members with zlib-ng")
+elseif(COMPRESSION_BACKEND STREQUAL "auto" OR COMPRESSION_BACKEND STREQUAL "miniz")
+    message(STATUS "Compressing zip members with miniz")
+else()
+    message(FATAL_ERROR "COMPRESSION_BACKEND is ${COMPRESSION_BACKEND} but it couldn't be found")
+endif()
+
+if(COMPRESSION_INCLUDE_DIR)
+    include_directories(${COMPRESSION_INCLUDE_DIR})
+endif()
+
 if(SHARED)
     add_library(xlnt.shared SHARED ${HEADERS} ${SOURCES} ${MINIZ} ${PUGIXML})
     target_compile_definitions(xlnt.shared PRIVATE XLNT_SHARED=1)
+    target_link_libraries(xlnt.shared ${CMAKE_THREAD_LIBS_INIT} ${COMPRESSION_LIBRARY})
+    if(COMPRESSION_DEFINITION)
+        target_compile_definitions(xlnt.shared PRIVATE ${COMPRESSION_DEFINITION})
+    endif()
     if(MSVC)
         target_compile_definitions(xlnt.shared PRIVATE XLNT_EXPORT=1)
         target_compile_definitions(xlnt.shared PRIVATE PUGIXML_API=__declspec\(dllexport\))
@@ -104,6 +152,10 @@ endif()
 if(STATIC)
     add_library(xlnt.static STATIC ${HEADERS} ${SOURCES} ${MINIZ} ${PUGIXML})
     target_compile_definitions(xlnt.static PUBLIC XLNT_STATIC=1)
+    target_link_libraries(xlnt.static ${CMAKE_THREAD_LIBS_INIT} ${COMPRESSION_LIBRARY})
+    if(COMPRESSION_DEFINITION)
+        target_compile_definitions(xlnt.static PRIVATE ${COMPRESSION_DEFINITION})
+    endif()
     install(TARGETS xlnt.static
         LIBRARY DESTINATION ${LIB_DEST_DIR}
         ARCHIVE DESTINATION ${LIB_DEST_DIR}
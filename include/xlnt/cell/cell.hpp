@@ -54,7 +54,11 @@ struct datetime;
 struct time;
 struct timedelta;
 
-namespace detail { struct cell_impl; }
+namespace detail {
+struct cell_impl;
+class format_builder;
+class worksheet_sax_handler;
+} // namespace detail
 
 /// <summary>
 /// Describes cell associated properties.
@@ -195,12 +199,9 @@ public:
     bool has_format() const;
 
     /// <summary>
-    /// Return a reference to the format applied to this cell.
-    /// </summary>
-    format &get_format();
-
-    /// <summary>
-    /// Return a reference to the format applied to this cell.
+    /// Return a reference to the format applied to this cell. Formats are shared
+    /// by every cell using them, so this can't be changed in place. Use set_format
+    /// or the setters below, which only add a format if an equal one doesn't exist.
     /// </summary>
     const format &get_format() const;
     
@@ -398,12 +399,20 @@ public:
 
 private:
     std::size_t get_format_id() const;
+
+    /// <summary>
+    /// Give this cell the format described by new_format, which is only built if
+    /// the workbook doesn't have an equal format already.
+    /// </summary>
+    void set_format(const detail::format_builder &new_format);
     
     // make these friends so they can use the private constructor
+    friend class range;
     friend class style;
     friend class worksheet;
     friend class worksheet_serializer;
     friend struct detail::cell_impl;
+    friend class detail::worksheet_sax_handler;
 
 	void guess_type_and_set_value(const std::string &value);
 
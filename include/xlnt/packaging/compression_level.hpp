@@ -21,19 +21,34 @@
 //
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
-#include <xlnt/utils/hashable.hpp>
+#pragma once
 
-namespace xlnt {
+#include <xlnt/xlnt_config.hpp>
 
-std::size_t hashable::hash() const
-{
-    static std::hash<std::string> hasher;
-    return hasher.operator()(to_hash_string());
-}
+namespace xlnt {
 
-bool hashable::operator==(const xlnt::hashable &other) const
+/// <summary>
+/// How hard the parts of an archive are compressed when it is written.
+/// Faster levels produce larger files.
+/// </summary>
+enum class XLNT_CLASS compression_level
 {
-    return hash() == other.hash();
-}
+    /// <summary>
+    /// Parts are stored without compression.
+    /// </summary>
+    store,
+    /// <summary>
+    /// The fastest deflate level.
+    /// </summary>
+    fast,
+    /// <summary>
+    /// The deflate level zlib uses by default.
+    /// </summary>
+    normal,
+    /// <summary>
+    /// The smallest output. This is the default.
+    /// </summary>
+    best
+};
 
 } // namespace xlnt
@@ -23,13 +23,16 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
+#include <xlnt/packaging/compression_level.hpp>
 
 // Note: this comes from https://github.com/tfussell/miniz-cpp
 
@@ -37,6 +40,13 @@ struct mz_zip_archive_tag;
 
 namespace xlnt {
 
+namespace detail {
+class deflate_pool;
+class deflate_streambuf;
+class mapped_file;
+struct zip_sink;
+}
+
 /// <summary>
 /// Information about a specific file in zip_file.
 /// </summary>
@@ -77,6 +87,60 @@ struct XLNT_CLASS zip_info
     std::size_t file_size;
 };
 
+/// <summary>
+/// An output stream which deflates everything written to it into memory as it
+/// goes. The result can be added to a zip_file with zip_file::writestr so that
+/// the uncompressed member is never held in memory at once.
+/// </summary>
+class XLNT_CLASS deflate_ostream : public std::ostream
+{
+public:
+    deflate_ostream();
+
+    /// <summary>
+    /// Construct a stream which compresses at the given level. When level is
+    /// compression_level::store, bytes are kept as they are written.
+    /// </summary>
+    deflate_ostream(compression_level level);
+
+    ~deflate_ostream();
+
+    /// <summary>
+    /// Compress any buffered bytes and end the deflate stream. Nothing can be
+    /// written to the stream afterwards. Calling this more than once has no effect.
+    /// </summary>
+    void finish();
+
+    /// <summary>
+    /// Return true if finish has been called.
+    /// </summary>
+    bool is_finished() const;
+
+    /// <summary>
+    /// Return the CRC-32 of the bytes compressed so far. Bytes written since the
+    /// last time the internal buffer filled up are only included after finish.
+    /// </summary>
+    std::uint32_t get_crc() const;
+
+    /// <summary>
+    /// Return the number of bytes compressed so far, before compression.
+    /// </summary>
+    std::size_t get_uncompressed_size() const;
+
+    /// <summary>
+    /// Return the level this stream compresses at.
+    /// </summary>
+    compression_level get_compression_level() const;
+
+    /// <summary>
+    /// Return the compressed bytes produced so far.
+    /// </summary>
+    const std::vector<char> &get_compressed() const;
+
+private:
+    std::unique_ptr<detail::deflate_streambuf> buffer_;
+};
+
 /// <summary>
 /// A compressed archive file that exists in memory which can read
 /// or write to and from the filesystem, std::iostreams, and byte vectors.
@@ -91,6 +155,12 @@ public:
     ~zip_file();
 
     // to/from file
+
+    /// <summary>
+    /// Load the archive at filename. Where possible the file is mapped into memory
+    /// rather than read so only the parts of it which are used are read from disk.
+    /// The file shouldn't be modified by anything else while it's loaded.
+    /// </summary>
     void load(const std::string &filename);
     void save(const std::string &filename);
 
@@ -102,6 +172,34 @@ public:
     void load(std::istream &stream);
     void save(std::ostream &stream);
 
+    /// <summary>
+    /// Start a new, empty archive which is written straight to stream as members
+    /// are added rather than being held in memory. save must then be called with
+    /// the same stream to finish it and the members can't be read back. If stream
+    /// can't seek, the archive is held in memory and written by save as usual
+    /// since miniz goes back to fill in each member's header once it's written.
+    /// </summary>
+    void begin_save(std::ostream &stream);
+
+    /// <summary>
+    /// Start a new, empty archive which is written straight into bytes as members
+    /// are added. save must then be called with bytes to finish it.
+    /// </summary>
+    void begin_save(std::vector<unsigned char> &bytes);
+
+    /// <summary>
+    /// Copy an archive which was loaded from a file into memory so that the file
+    /// can be overwritten while the archive is still being read. Does nothing if
+    /// the archive isn't mapped from a file.
+    /// </summary>
+    void release_file();
+
+    /// <summary>
+    /// Return true if the archive is still mapped from the file called filename,
+    /// even if filename is a different path to it than the one it was loaded from.
+    /// </summary>
+    bool is_mapped_from(const std::string &filename) const;
+
     void reset();
 
     bool has_file(const std::string &name);
@@ -131,6 +229,20 @@ public:
     std::string read(const std::string &name);
     std::string read(const zip_info &name);
 
+    /// <summary>
+    /// Decompress the member called name in fixed-size windows, passing each chunk
+    /// to callback in order. Unlike read, the member is never held in memory at once.
+    /// </summary>
+    void read(const std::string &name, const std::function<void(const char *, std::size_t)> &callback);
+    void read(const zip_info &name, const std::function<void(const char *, std::size_t)> &callback);
+
+    /// <summary>
+    /// Return a stream which inflates the member called name as it is read rather
+    /// than all at once. The stream reads directly from this archive's buffer so it
+    /// must not be used after the archive is modified or destroyed.
+    /// </summary>
+    std::unique_ptr<std::istream> read_stream(const std::string &name);
+
     std::pair<bool, std::string> testzip();
 
     void write(const std::string &filename);
@@ -139,8 +251,66 @@ public:
     void writestr(const std::string &arcname, const std::string &bytes);
     void writestr(const zip_info &arcname, const std::string &bytes);
 
+    /// <summary>
+    /// Add bytes as the member called arcname. If parallel compression is enabled,
+    /// bytes are moved into the archive rather than copied.
+    /// </summary>
+    void writestr(const std::string &arcname, std::string &&bytes);
+
+    /// <summary>
+    /// Finish stream and add its already compressed contents to the archive as
+    /// the member called arcname. The level stream was created with is used
+    /// rather than the one set for arcname.
+    /// </summary>
+    void writestr(const std::string &arcname, deflate_ostream &stream);
+
+    /// <summary>
+    /// Copy the member called arcname from source into this archive as it is,
+    /// compressed data and all, rather than inflating and deflating it again.
+    /// </summary>
+    void copy_member(zip_file &source, const std::string &arcname);
+
+    /// <summary>
+    /// Return the level members are compressed at when they are written unless
+    /// a level has been set for a particular member.
+    /// </summary>
+    compression_level get_compression_level() const;
+
+    /// <summary>
+    /// Set the level members are compressed at when they are written. This
+    /// defaults to compression_level::best.
+    /// </summary>
+    void set_compression_level(compression_level level);
+
+    /// <summary>
+    /// Return the level the member called arcname will be compressed at.
+    /// </summary>
+    compression_level get_compression_level(const std::string &arcname) const;
+
+    /// <summary>
+    /// Compress the member called arcname at level rather than the level set
+    /// for the whole archive when it is written.
+    /// </summary>
+    void set_compression_level(const std::string &arcname, compression_level level);
+
+    /// <summary>
+    /// If parallel compression is enabled, members added with writestr are
+    /// deflated on a pool of threads while the caller goes on to prepare the next
+    /// one. Members are still laid out in the order they were added so the archive
+    /// is the same as it would be otherwise. This defaults to false.
+    /// </summary>
+    bool get_parallel_compression() const;
+    void set_parallel_compression(bool parallel_compression);
+
     std::string get_filename() const;
 
+    /// <summary>
+    /// Return the name of the library members are deflated, inflated and
+    /// checksummed with, "miniz", "libdeflate" or "zlib-ng". This is chosen when
+    /// xlnt is built.
+    /// </summary>
+    static std::string get_compression_backend();
+
     std::string comment;
 
 private:
@@ -150,12 +320,76 @@ private:
     void append_comment();
     void remove_comment();
 
-    zip_info getinfo(int index);
+    /// <summary>
+    /// Finish an archive started by begin_save if the given destination is the one
+    /// it was started with. Returns false if begin_save wasn't called.
+    /// </summary>
+    bool end_save(const void *destination);
+
+    /// <summary>
+    /// Add members which have been deflated in parallel to the archive in the
+    /// order they were written, waiting for the rest to finish if wait is true.
+    /// </summary>
+    void write_pending(bool wait);
+
+    /// <summary>
+    /// Compress bytes at the level set for arcname and add them to the archive.
+    /// </summary>
+    void add_member(const std::string &arcname, const std::string &bytes, const std::string &comment);
+
+    /// <summary>
+    /// Note that the member called arcname is being written again so the copy of
+    /// it in the archive this one was loaded from shouldn't be kept.
+    /// </summary>
+    void replace_member(const std::string &arcname);
+
+    /// <summary>
+    /// Copy members of the archive this one was loaded from which haven't been
+    /// written again, as they are, then let go of it. Done just before the
+    /// archive is finalized.
+    /// </summary>
+    void copy_unmodified();
+    void close_source();
+
+    const char *get_data() const;
+    std::size_t get_size() const;
+
+    /// <summary>
+    /// Record the information about each member of an archive which has just
+    /// been opened for reading and index the members by name.
+    /// </summary>
+    void index_members();
+
+    /// <summary>
+    /// Return the index of the member called name, ignoring ASCII case like
+    /// miniz does, or -1 if there isn't one.
+    /// </summary>
+    int find_member(const std::string &name);
 
     std::unique_ptr<mz_zip_archive_tag> archive_;
     std::vector<char> buffer_;
+    std::unique_ptr<detail::mapped_file> mapped_;
+    std::unique_ptr<detail::zip_sink> sink_;
+    std::unique_ptr<detail::deflate_pool> deflate_pool_;
+
+    // the central directory of an archive being read, looked up by name through a
+    // hash map rather than by searching the directory each time
+    std::vector<zip_info> members_;
+    std::unordered_map<std::string, std::size_t> member_indices_;
+
+    // Once members are written to a loaded archive, the loaded archive is kept
+    // as it was until it's saved so that members which weren't replaced can be
+    // copied straight from it.
+    std::unique_ptr<mz_zip_archive_tag> source_;
+    std::vector<char> source_buffer_;
+    std::unordered_map<std::string, std::size_t> source_indices_;
+    std::vector<bool> replaced_;
+
     std::stringstream open_stream_;
     std::string filename_;
+    compression_level compression_level_;
+    std::unordered_map<std::string, compression_level> member_compression_levels_;
+    bool parallel_compression_;
 };
 
 } // namespace xlnt
@@ -57,8 +57,9 @@ public:
     
     bool get_shrink_to_fit() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const alignment &other) const;
+
+    std::size_t hash() const override;
 
 private:
     horizontal_alignment horizontal_ = horizontal_alignment::general;
@@ -95,9 +95,11 @@ public:
     bool protection_applied() const;
     void protection_applied(bool applied);
     
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const base_format &other) const;
+
+    std::size_t hash() const override;
 
+protected:
     alignment alignment_;
     border border_;
     fill fill_;
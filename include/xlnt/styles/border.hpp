@@ -61,8 +61,9 @@ public:
     std::experimental::optional<side> &get_horizontal();
     const std::experimental::optional<side> &get_horizontal() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const border &other) const;
+
+    std::size_t hash() const override;
 
 private:
     std::experimental::optional<side> start_;
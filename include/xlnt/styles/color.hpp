@@ -80,8 +80,9 @@ public:
 
     std::string get_rgb_string() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const color &other) const;
+
+    std::size_t hash() const override;
 
 private:
     type type_ = type::indexed;
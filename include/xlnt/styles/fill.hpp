@@ -77,8 +77,9 @@ public:
 
     const std::experimental::optional<color> &get_background_color() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const pattern_fill &other) const;
+
+    std::size_t hash() const override;
 
 private:
     type type_ = type::none;
@@ -132,8 +133,9 @@ public:
     
     const std::unordered_map<double, color> &get_stops() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const gradient_fill &other) const;
+
+    std::size_t hash() const override;
 
 private:
     type type_ = type::linear;
@@ -174,8 +176,9 @@ public:
 
     const pattern_fill &get_pattern_fill() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const fill &other) const;
+
+    std::size_t hash() const override;
 
 private:
     type type_ = type::pattern;
@@ -92,8 +92,9 @@ public:
 
     std::size_t get_family() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const font &other) const;
+
+    std::size_t hash() const override;
 
 private:
     friend class style;
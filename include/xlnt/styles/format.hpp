@@ -40,8 +40,9 @@ public:
     format(const format &other);
     format &operator=(const format &other);
     
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const format &other) const;
+
+    std::size_t hash() const override;
 };
 
 } // namespace xlnt
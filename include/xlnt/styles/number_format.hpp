@@ -88,8 +88,9 @@ public:
 
     bool is_date_format() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const number_format &other) const;
+
+    std::size_t hash() const override;
 
 private:
     bool id_set_;
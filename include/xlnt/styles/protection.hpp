@@ -45,8 +45,9 @@ public:
     bool get_hidden() const;
     void set_hidden(bool hidden);
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const protection &other) const;
+
+    std::size_t hash() const override;
 
 private:
     bool locked_;
@@ -49,8 +49,9 @@ public:
 
     const std::experimental::optional<color> &get_color() const;
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const side &other) const;
+
+    std::size_t hash() const override;
 
 private:
     std::experimental::optional<border_style> border_style_;
@@ -52,8 +52,9 @@ public:
     std::size_t get_builtin_id() const;
     void set_builtin_id(std::size_t builtin_id);
 
-protected:
-    std::string to_hash_string() const override;
+    bool operator==(const style &other) const;
+
+    std::size_t hash() const override;
 
 private:
     std::string name_;
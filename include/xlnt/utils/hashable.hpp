@@ -22,21 +22,24 @@
 // @author: see AUTHORS file
 #pragma once
 
-#include <cstdint>
-#include <string>
+#include <cstddef>
+#include <functional>
 
 #include <xlnt/xlnt_config.hpp>
 
 namespace xlnt {
 
+/// <summary>
+/// Interface for types which can be stored in hashed containers.
+/// Implementations combine their fields directly rather than building
+/// an intermediate string, and provide a matching operator==.
+/// </summary>
 class XLNT_CLASS hashable
 {
 public:
-    std::size_t hash() const;
-    bool operator==(const hashable &other) const;
+    virtual ~hashable() = default;
 
-protected:
-    virtual std::string to_hash_string() const = 0;
+    virtual std::size_t hash() const = 0;
 };
 
 } // namespace xlnt
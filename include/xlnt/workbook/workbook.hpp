@@ -63,6 +63,7 @@ class worksheet;
 class worksheet_iterator;
 class zip_file;
 
+enum class compression_level;
 enum class relationship_type;
 
 namespace detail {
@@ -118,6 +119,74 @@ public:
     bool get_read_only() const;
     void set_read_only(bool read_only);
 
+    /// <summary>
+    /// In optimized write mode, each worksheet::append writes the rows appended
+    /// before it straight to the compressed worksheet part and removes their cells,
+    /// so the most recently appended row is the only one held in memory. Rows
+    /// must be appended in order and properties preceding the cells in the part,
+    /// such as column widths and frozen panes, must be set before the first append.
+    /// Worksheets which have had rows written this way can't be copied.
+    /// </summary>
+    bool get_optimized_write() const;
+    void set_optimized_write(bool optimized_write);
+
+    /// <summary>
+    /// If parallel load is enabled, the worksheets of a workbook being loaded are
+    /// parsed at once on as many threads as the hardware supports once the shared
+    /// strings and stylesheet have been read. The loaded workbook is the same as
+    /// it would be otherwise. This has no effect on read-only workbooks.
+    /// </summary>
+    bool get_parallel_load() const;
+    void set_parallel_load(bool parallel_load);
+
+    /// <summary>
+    /// If parallel save is enabled, parts of the workbook being saved are
+    /// compressed on as many threads as the hardware supports while the next
+    /// part is being serialized. The saved file is the same as it would be
+    /// otherwise.
+    /// </summary>
+    bool get_parallel_save() const;
+    void set_parallel_save(bool parallel_save);
+
+    /// <summary>
+    /// If this is enabled when a workbook is loaded, the file it was loaded from
+    /// is kept open and worksheets which haven't been modified since are copied
+    /// from it as they are when the workbook is saved rather than being written
+    /// again. A worksheet counts as modified once anything which could change it
+    /// is called, including getting a cell or range from a non-const worksheet.
+    /// Sheets with relationships to other parts, such as printer settings or
+    /// drawings, or with conditional formatting are always written again.
+    /// </summary>
+    bool get_copy_unmodified_sheets() const;
+    void set_copy_unmodified_sheets(bool copy_unmodified_sheets);
+
+    /// <summary>
+    /// If style compaction is enabled, formats which no cell or column uses are
+    /// removed when the workbook is saved, along with the fonts, fills, borders
+    /// and number formats only they used. Cells are given the new format ids
+    /// in the workbook itself as well as in the saved file. This is skipped when
+    /// any worksheet is copied from the source file, streamed from it in a
+    /// read-only workbook or has had rows written in optimized write mode, since
+    /// those refer to format ids which can't be changed.
+    /// </summary>
+    bool get_compact_styles() const;
+    void set_compact_styles(bool compact_styles);
+
+    /// <summary>
+    /// The level parts of the workbook are compressed at when it is saved unless
+    /// a level has been set for a particular part. Worksheets written in optimized
+    /// write mode are compressed at the level set when their first row is appended.
+    /// </summary>
+    compression_level get_compression_level() const;
+    void set_compression_level(compression_level level);
+
+    /// <summary>
+    /// The level the part at the given path in the package, such as
+    /// "xl/worksheets/sheet1.xml", is compressed at when the workbook is saved.
+    /// </summary>
+    compression_level get_compression_level(const std::string &part) const;
+    void set_compression_level(const std::string &part, compression_level level);
+
     // add worksheets
 
     worksheet create_sheet();
@@ -232,7 +301,6 @@ public:
 
     // formats
     
-    format &get_format(std::size_t format_index);
     const format &get_format(std::size_t format_index) const;
     std::size_t add_format(const format &new_format);
     void clear_formats();
@@ -266,7 +334,11 @@ public:
 
     // shared strings
 
-    void add_shared_string(const text &shared, bool allow_duplicates=false);
+    /// <summary>
+    /// Add shared to the shared string table unless allow_duplicates is false and
+    /// an equal string is already there. Return the index of the string in the table.
+    /// </summary>
+    std::size_t add_shared_string(const text &shared, bool allow_duplicates=false);
     std::vector<text> &get_shared_strings();
     const std::vector<text> &get_shared_strings() const;
     
@@ -306,6 +378,7 @@ public:
     bool operator!=(const workbook &rhs) const;
 
 private:
+    friend class cell;
     friend class excel_serializer;
     friend class worksheet;
 
@@ -319,6 +392,18 @@ private:
     /// </summary>
     std::string next_relationship_id() const;
 
+    /// <summary>
+    /// Throw sheet_title_error if title can't be used for a worksheet, otherwise
+    /// return it with a number appended if a worksheet already has that title.
+    /// </summary>
+    std::string validate_sheet_title(const std::string &title) const;
+
+    /// <summary>
+    /// Append a worksheet with the given title. Unlike create_sheet, this works on
+    /// read-only workbooks so that their worksheets can be loaded.
+    /// </summary>
+    worksheet add_sheet(const std::string &title);
+
     /// <summary>
     /// Apply the function "f" to every cell in every worksheet in this workbook.
     /// </summary>
@@ -22,6 +22,7 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -37,7 +38,14 @@
 
 namespace xlnt {
 
+class alignment;
+class border;
 class const_range_iterator;
+class fill;
+class font;
+class format;
+class number_format;
+class protection;
 class range_iterator;
 
 /// <summary>
@@ -76,6 +84,34 @@ public:
     std::size_t length() const;
 
     bool contains(const cell_reference &ref);
+
+    /// <summary>
+    /// Call modify on a copy of the format of each cell in this range and give the
+    /// cell the result. modify is called once per distinct format in the range
+    /// rather than once per cell, so it shouldn't depend on which cell it's for.
+    /// Cells which don't exist yet are created.
+    /// </summary>
+    void apply_format(const std::function<void(format &)> &modify);
+
+    /// <summary>
+    /// Give every cell in this range the same format, adding it to the workbook once.
+    /// </summary>
+    void set_format(const format &new_format);
+
+    // These behave like the cell methods of the same name applied to every cell
+    // in this range, but go through apply_format.
+
+    void set_number_format(const number_format &new_number_format);
+
+    void set_font(const font &new_font);
+
+    void set_fill(const fill &new_fill);
+
+    void set_border(const border &new_border);
+
+    void set_alignment(const alignment &new_alignment);
+
+    void set_protection(const protection &new_protection);
     
     iterator begin();
     iterator end();
@@ -96,6 +132,13 @@ public:
     const_reverse_iterator crend() const;
 
 private:
+    /// <summary>
+    /// Like apply_format, but cells without a format are given a modified copy of
+    /// a default format rather than of the workbook's first format if
+    /// unformatted_from_default is true.
+    /// </summary>
+    void apply_format(const std::function<void(format &)> &modify, bool unformatted_from_default);
+
     worksheet ws_;
     range_reference ref_;
     major_order order_;
@@ -55,6 +55,8 @@ class workbook;
 struct date;
 
 namespace detail {
+class worksheet_row_reader;
+class worksheet_row_writer;
 struct worksheet_impl;
 }
 
@@ -245,11 +247,32 @@ public:
 private:
     friend class workbook;
     friend class cell;
+    friend class range;
     friend class range_iterator;
     friend class const_range_iterator;
+    friend class worksheet_serializer;
+    friend class detail::worksheet_row_writer;
     
     std::size_t next_custom_number_format_id();
 
+    /// <summary>
+    /// Return the reader streaming this sheet's cells from its source archive, creating
+    /// it if needed, or nullptr if the cells were loaded into memory.
+    /// </summary>
+    detail::worksheet_row_reader *get_row_reader() const;
+
+    /// <summary>
+    /// Return the writer streaming this sheet's appended rows, creating it if the
+    /// workbook is in optimized write mode, or nullptr otherwise.
+    /// </summary>
+    detail::worksheet_row_writer *get_row_writer() const;
+
+    /// <summary>
+    /// Return the row to be filled by the next call to append. Rows buffered by
+    /// the row writer are written out first.
+    /// </summary>
+    row_t prepare_append();
+
     worksheet(detail::worksheet_impl *d);
     detail::worksheet_impl *d_;
 };
@@ -36,6 +36,7 @@
 
 // packaging
 #include <xlnt/packaging/app_properties.hpp>
+#include <xlnt/packaging/compression_level.hpp>
 #include <xlnt/packaging/default_type.hpp>
 #include <xlnt/packaging/document_properties.hpp>
 #include <xlnt/packaging/manifest.hpp>
@@ -46,10 +46,19 @@
 
 #include <detail/cell_impl.hpp>
 #include <detail/comment_impl.hpp>
+#include <detail/format_builder.hpp>
+#include <detail/workbook_impl.hpp>
 
 
 namespace {
 
+// Strings share their storage with numbers, so they read as 0 rather than as
+// their shared string index.
+long double numeric_value(const xlnt::detail::cell_impl &d)
+{
+    return d.type_ == xlnt::cell::type::string ? 0 : d.value_numeric_;
+}
+
 std::pair<bool, long double> cast_numeric(const std::string &s)
 {
 	const char *str = s.c_str();
@@ -296,7 +305,7 @@ XLNT_FUNCTION void cell::set_value(std::string s)
 
 	if (s.size() > 1 && s.front() == '=')
 	{
-		d_->type_ = type::formula;
+		set_data_type(type::formula);
 		set_formula(s);
 	}
 	else if (cell::error_codes().find(s) != cell::error_codes().end())
@@ -306,11 +315,13 @@ XLNT_FUNCTION void cell::set_value(std::string s)
 	else
 	{
 		d_->type_ = type::string;
-        d_->value_text_.set_plain_string(s);
-        
+        d_->value_string_ = detail::cell_impl::empty_string;
+
         if (s.size() > 0)
         {
-            get_workbook().add_shared_string(d_->value_text_);
+            text shared;
+            shared.set_plain_string(s);
+            d_->value_string_ = get_workbook().add_shared_string(shared);
         }
 	}
 
@@ -330,8 +341,7 @@ XLNT_FUNCTION void cell::set_value(text t)
     else
     {
         d_->type_ = type::string;
-        d_->value_text_ = t;
-        get_workbook().add_shared_string(t);
+        d_->value_string_ = get_workbook().add_shared_string(t);
     }
 }
 
@@ -344,12 +354,46 @@ XLNT_FUNCTION void cell::set_value(char const *c)
 template <>
 XLNT_FUNCTION void cell::set_value(cell c)
 {
-    d_->type_ = c.d_->type_;
-    d_->value_numeric_ = c.d_->value_numeric_;
-    d_->value_text_ = c.d_->value_text_;
-    d_->hyperlink_ = c.d_->hyperlink_;
-    d_->has_hyperlink_ = c.d_->has_hyperlink_;
-    d_->formula_ = c.d_->formula_;
+    if (c.get_data_type() == type::string && &c.get_workbook() != &get_workbook())
+    {
+        // string indices refer to the other workbook's shared strings
+        const auto &shared_strings = c.get_workbook().get_shared_strings();
+
+        if (c.d_->value_string_ < shared_strings.size())
+        {
+            set_value(shared_strings[c.d_->value_string_]);
+        }
+        else
+        {
+            set_value(std::string());
+        }
+    }
+    else
+    {
+        d_->type_ = c.d_->type_;
+
+        if (d_->type_ == type::string)
+        {
+            d_->value_string_ = c.d_->value_string_;
+        }
+        else
+        {
+            d_->value_numeric_ = c.d_->value_numeric_;
+        }
+    }
+
+    if (c.d_->extras_ != nullptr || d_->extras_ != nullptr)
+    {
+        const detail::cell_extras none;
+        const auto &source = c.d_->extras_ == nullptr ? none : *c.d_->extras_;
+        auto &extras = d_->extras();
+
+        extras.hyperlink_ = source.hyperlink_;
+        extras.has_hyperlink_ = source.has_hyperlink_;
+        extras.formula_ = source.formula_;
+        extras.error_ = source.error_;
+    }
+
     d_->format_id_ = c.d_->format_id_;
     if (c.has_comment()) set_comment(c.get_comment());
 }
@@ -398,12 +442,15 @@ column_t cell::get_column() const
 
 void cell::set_merged(bool merged)
 {
-    d_->is_merged_ = merged;
+    if (merged || d_->extras_ != nullptr)
+    {
+        d_->extras().is_merged_ = merged;
+    }
 }
 
 bool cell::is_merged() const
 {
-    return d_->is_merged_;
+    return d_->extras_ != nullptr && d_->extras_->is_merged_;
 }
 
 bool cell::is_date() const
@@ -439,17 +486,17 @@ std::string cell::to_repr() const
 
 relationship cell::get_hyperlink() const
 {
-    if (!d_->has_hyperlink_)
+    if (!has_hyperlink())
     {
         throw std::runtime_error("no hyperlink set");
     }
 
-    return d_->hyperlink_;
+    return d_->extras_->hyperlink_;
 }
 
 bool cell::has_hyperlink() const
 {
-    return d_->has_hyperlink_;
+    return d_->extras_ != nullptr && d_->extras_->has_hyperlink_;
 }
 
 void cell::set_hyperlink(const std::string &hyperlink)
@@ -459,8 +506,9 @@ void cell::set_hyperlink(const std::string &hyperlink)
         throw data_type_error();
     }
 
-    d_->has_hyperlink_ = true;
-    d_->hyperlink_ = worksheet(d_->parent_).create_relationship(relationship::type::hyperlink, hyperlink);
+    auto &extras = d_->extras();
+    extras.has_hyperlink_ = true;
+    extras.hyperlink_ = worksheet(d_->parent_).create_relationship(relationship::type::hyperlink, hyperlink);
 
     if (get_data_type() == type::null)
     {
@@ -477,37 +525,40 @@ void cell::set_formula(const std::string &formula)
 
     if (formula[0] == '=')
     {
-        d_->formula_ = formula.substr(1);
+        d_->extras().formula_ = formula.substr(1);
     }
     else
     {
-        d_->formula_ = formula;
+        d_->extras().formula_ = formula;
     }
 }
 
 bool cell::has_formula() const
 {
-    return !d_->formula_.empty();
+    return d_->extras_ != nullptr && !d_->extras_->formula_.empty();
 }
 
 std::string cell::get_formula() const
 {
-    if (d_->formula_.empty())
+    if (!has_formula())
     {
         throw data_type_error();
     }
 
-    return d_->formula_;
+    return d_->extras_->formula_;
 }
 
 void cell::clear_formula()
 {
-    d_->formula_.clear();
+    if (d_->extras_ != nullptr)
+    {
+        d_->extras_->formula_.clear();
+    }
 }
 
 void cell::set_comment(const xlnt::comment &c)
 {
-    if (c.d_ != d_->comment_.get())
+    if (c.d_ != (d_->extras_ == nullptr ? nullptr : d_->extras_->comment_.get()))
     {
         throw xlnt::attribute_error();
     }
@@ -525,14 +576,13 @@ void cell::clear_comment()
     if (has_comment())
     {
         get_worksheet().decrement_comments();
+        d_->extras_->comment_ = nullptr;
     }
-
-    d_->comment_ = nullptr;
 }
 
 bool cell::has_comment() const
 {
-    return d_->comment_ != nullptr;
+    return d_->extras_ != nullptr && d_->extras_->comment_ != nullptr;
 }
 
 void cell::set_error(const std::string &error)
@@ -542,8 +592,8 @@ void cell::set_error(const std::string &error)
         throw data_type_error();
     }
 
-    d_->value_text_.set_plain_string(error);
-    d_->type_ = type::error;
+    d_->extras().error_ = error;
+    set_data_type(type::error);
 }
 
 cell cell::offset(int column, int row)
@@ -572,13 +622,15 @@ const workbook &cell::get_workbook() const
 }
 comment cell::get_comment()
 {
-    if (d_->comment_ == nullptr)
+    auto &extras = d_->extras();
+
+    if (extras.comment_ == nullptr)
     {
-        d_->comment_.reset(new detail::comment_impl());
+        extras.comment_.reset(new detail::comment_impl());
         get_worksheet().increment_comments();
     }
 
-    return comment(d_->comment_.get());
+    return comment(extras.comment_.get());
 }
 
 //TODO: this shares a lot of code with worksheet::get_point_pos, try to reduce repition
@@ -642,6 +694,15 @@ cell::type cell::get_data_type() const
 
 void cell::set_data_type(type t)
 {
+    if (t == type::string && d_->type_ != type::string)
+    {
+        d_->value_string_ = detail::cell_impl::empty_string;
+    }
+    else if (t != type::string && d_->type_ == type::string)
+    {
+        d_->value_numeric_ = 0;
+    }
+
     d_->type_ = t;
 }
 
@@ -720,154 +781,145 @@ const protection &cell::get_protection() const
 void cell::clear_value()
 {
     d_->value_numeric_ = 0;
-    d_->value_text_.clear();
-    d_->formula_.clear();
     d_->type_ = cell::type::null;
+
+    if (d_->extras_ != nullptr)
+    {
+        d_->extras_->formula_.clear();
+        d_->extras_->error_.clear();
+    }
 }
 
 template <>
 XLNT_FUNCTION bool cell::get_value() const
 {
-    return d_->value_numeric_ != 0;
+    return numeric_value(*d_) != 0;
 }
 
 template <>
 XLNT_FUNCTION std::int8_t cell::get_value() const
 {
-    return static_cast<std::int8_t>(d_->value_numeric_);
+    return static_cast<std::int8_t>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION std::int16_t cell::get_value() const
 {
-    return static_cast<std::int16_t>(d_->value_numeric_);
+    return static_cast<std::int16_t>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION std::int32_t cell::get_value() const
 {
-    return static_cast<std::int32_t>(d_->value_numeric_);
+    return static_cast<std::int32_t>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION std::int64_t cell::get_value() const
 {
-    return static_cast<std::int64_t>(d_->value_numeric_);
+    return static_cast<std::int64_t>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION std::uint8_t cell::get_value() const
 {
-    return static_cast<std::uint8_t>(d_->value_numeric_);
+    return static_cast<std::uint8_t>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION std::uint16_t cell::get_value() const
 {
-    return static_cast<std::uint16_t>(d_->value_numeric_);
+    return static_cast<std::uint16_t>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION std::uint32_t cell::get_value() const
 {
-    return static_cast<std::uint32_t>(d_->value_numeric_);
+    return static_cast<std::uint32_t>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION std::uint64_t cell::get_value() const
 {
-    return static_cast<std::uint64_t>(d_->value_numeric_);
+    return static_cast<std::uint64_t>(numeric_value(*d_));
 }
 
 #ifdef __linux
 template <>
 XLNT_FUNCTION long long cell::get_value() const
 {
-    return static_cast<long long>(d_->value_numeric_);
+    return static_cast<long long>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION unsigned long long cell::get_value() const
 {
-    return static_cast<unsigned long long>(d_->value_numeric_);
+    return static_cast<unsigned long long>(numeric_value(*d_));
 }
 #endif
 
 template <>
 XLNT_FUNCTION float cell::get_value() const
 {
-    return static_cast<float>(d_->value_numeric_);
+    return static_cast<float>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION double cell::get_value() const
 {
-    return static_cast<double>(d_->value_numeric_);
+    return static_cast<double>(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION long double cell::get_value() const
 {
-    return d_->value_numeric_;
+    return numeric_value(*d_);
 }
 
 template <>
 XLNT_FUNCTION time cell::get_value() const
 {
-    return time::from_number(d_->value_numeric_);
+    return time::from_number(numeric_value(*d_));
 }
 
 template <>
 XLNT_FUNCTION datetime cell::get_value() const
 {
-    return datetime::from_number(d_->value_numeric_, get_base_date());
+    return datetime::from_number(numeric_value(*d_), get_base_date());
 }
 
 template <>
 XLNT_FUNCTION date cell::get_value() const
 {
-    return date::from_number(static_cast<int>(d_->value_numeric_), get_base_date());
+    return date::from_number(static_cast<int>(numeric_value(*d_)), get_base_date());
 }
 
 template <>
 XLNT_FUNCTION timedelta cell::get_value() const
 {
-    return timedelta::from_number(d_->value_numeric_);
+    return timedelta::from_number(numeric_value(*d_));
 }
 
 void cell::set_border(const xlnt::border &border_)
 {
-    d_->has_format_ = true;
-    auto format_copy = get_workbook().get_format(d_->format_id_);
-    format_copy.set_border(border_);
-    d_->format_id_ = get_workbook().add_format(format_copy);
+    set_format(detail::format_builder(get_format()).set_border(border_));
 }
 
 void cell::set_fill(const xlnt::fill &fill_)
 {
-    d_->has_format_ = true;
-    auto format_copy = get_workbook().get_format(d_->format_id_);
-    format_copy.set_fill(fill_);
-    d_->format_id_ = get_workbook().add_format(format_copy);
+    set_format(detail::format_builder(get_format()).set_fill(fill_));
 }
 
 void cell::set_font(const font &font_)
 {
-    d_->has_format_ = true;
-    auto format_copy = get_workbook().get_format(d_->format_id_);
-    format_copy.set_font(font_);
-    d_->format_id_ = get_workbook().add_format(format_copy);
+    set_format(detail::format_builder(get_format()).set_font(font_));
 }
 
 void cell::set_number_format(const number_format &number_format_)
 {
-    format new_format;
-    
-    if (d_->has_format_)
-    {
-        new_format = get_workbook().get_format(d_->format_id_);
-    }
-    
+    format default_format;
+    const auto &base_format = d_->has_format_ ? get_format() : default_format;
+
     auto number_format_with_id = number_format_;
     
     if (!number_format_with_id.has_id())
@@ -875,38 +927,57 @@ void cell::set_number_format(const number_format &number_format_)
         number_format_with_id.set_id(get_worksheet().next_custom_number_format_id());
     }
     
-    new_format.set_number_format(number_format_with_id);
-    
-    d_->has_format_ = true;
-    d_->format_id_ = get_workbook().add_format(new_format);
+    set_format(detail::format_builder(base_format).set_number_format(number_format_with_id));
 }
 
 void cell::set_alignment(const xlnt::alignment &alignment_)
 {
-    d_->has_format_ = true;
-    auto format_copy = get_workbook().get_format(d_->format_id_);
-    format_copy.set_alignment(alignment_);
-    d_->format_id_ = get_workbook().add_format(format_copy);
+    set_format(detail::format_builder(get_format()).set_alignment(alignment_));
 }
 
 void cell::set_protection(const xlnt::protection &protection_)
 {
-    d_->has_format_ = true;
-    auto format_copy = get_workbook().get_format(d_->format_id_);
-    format_copy.set_protection(protection_);
-    d_->format_id_ = get_workbook().add_format(format_copy);
+    set_format(detail::format_builder(get_format()).set_protection(protection_));
 }
 
 template <>
 XLNT_FUNCTION std::string cell::get_value() const
 {
-    return d_->value_text_.get_plain_string();
+    if (d_->type_ == type::error)
+    {
+        return d_->extras_ == nullptr ? std::string() : d_->extras_->error_;
+    }
+
+    if (d_->type_ == type::string)
+    {
+        const auto &shared_strings = get_workbook().get_shared_strings();
+
+        if (d_->value_string_ < shared_strings.size())
+        {
+            return shared_strings[d_->value_string_].get_plain_string();
+        }
+    }
+
+    return std::string();
 }
 
 template <>
 XLNT_FUNCTION text cell::get_value() const
 {
-    return d_->value_text_;
+    if (d_->type_ == type::string)
+    {
+        const auto &shared_strings = get_workbook().get_shared_strings();
+
+        if (d_->value_string_ < shared_strings.size())
+        {
+            return shared_strings[d_->value_string_];
+        }
+    }
+
+    text value;
+    value.set_plain_string(get_value<std::string>());
+
+    return value;
 }
 
 bool cell::has_value() const
@@ -935,7 +1006,7 @@ std::string cell::to_string() const
     }
 }
 
-format &cell::get_format()
+const format &cell::get_format() const
 {
     return get_workbook().get_format(d_->format_id_);
 }
@@ -947,7 +1018,13 @@ bool cell::has_format() const
 
 void cell::set_format(const format &new_format)
 {
-    d_->format_id_ = get_workbook().add_format(new_format);
+    d_->format_id_ = static_cast<std::uint32_t>(get_workbook().add_format(new_format));
+    d_->has_format_ = true;
+}
+
+void cell::set_format(const detail::format_builder &new_format)
+{
+    d_->format_id_ = static_cast<std::uint32_t>(get_workbook().d_->stylesheet_.add_format(new_format));
     d_->has_format_ = true;
 }
 
@@ -1007,49 +1084,54 @@ void cell::clear_format()
 
 void cell::clear_style()
 {
-    d_->style_id_ = 0;
-    d_->has_style_ = false;
+    if (d_->extras_ != nullptr)
+    {
+        d_->extras_->style_id_ = 0;
+        d_->extras_->has_style_ = false;
+    }
 }
 
 void cell::set_style(const style &new_style)
 {
-    d_->has_style_ = true;
+    auto &extras = d_->extras();
+    extras.has_style_ = true;
 
     if (get_workbook().has_style(new_style.get_name()))
     {
-        d_->style_id_ = get_workbook().get_style_id(new_style.get_name());
+        extras.style_id_ = get_workbook().get_style_id(new_style.get_name());
     }
     else
     {
-        d_->style_id_ = get_workbook().add_style(new_style);
+        extras.style_id_ = get_workbook().add_style(new_style);
     }
 }
 
 void cell::set_style(const std::string &style_name)
 {
-    d_->has_style_ = true;
+    auto &extras = d_->extras();
+    extras.has_style_ = true;
     
     if (!get_workbook().has_style(style_name))
     {
         throw std::runtime_error("style " + style_name + " doesn't exist in workbook");
     }
     
-    d_->style_id_ = get_workbook().get_style_id(style_name);
+    extras.style_id_ = get_workbook().get_style_id(style_name);
 }
 
 const style &cell::get_style() const
 {
-    if (!d_->has_style_)
+    if (!has_style())
     {
         throw std::runtime_error("cell has no style");
     }
 
-    return get_workbook().get_style_by_id(d_->style_id_);
+    return get_workbook().get_style_by_id(d_->extras_->style_id_);
 }
 
 bool cell::has_style() const
 {
-    return d_->has_style_;
+    return d_->extras_ != nullptr && d_->extras_->has_style_;
 }
 
 } // namespace xlnt
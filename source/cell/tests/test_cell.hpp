@@ -114,7 +114,45 @@ public:
         cell.set_value("0800");
         TS_ASSERT(cell.get_data_type() == xlnt::cell::type::string);
     }
-    
+
+    void test_string_shared()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value("repeated");
+        ws.get_cell("A2").set_value("repeated");
+        ws.get_cell("A3").set_value("");
+        TS_ASSERT_EQUALS(wb.get_shared_strings().size(), 1);
+        TS_ASSERT_EQUALS(ws.get_cell("A2").get_value<std::string>(), "repeated");
+        TS_ASSERT_EQUALS(ws.get_cell("A3").get_value<std::string>(), "");
+        TS_ASSERT(ws.get_cell("A3").get_data_type() == xlnt::cell::type::string);
+
+        xlnt::workbook other;
+        auto other_cell = other.get_active_sheet().get_cell("A1");
+        other_cell.set_value(ws.get_cell("A1"));
+        TS_ASSERT_EQUALS(other_cell.get_value<std::string>(), "repeated");
+        TS_ASSERT_EQUALS(other.get_shared_strings().size(), 1);
+    }
+
+    void test_string_numeric_value()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("A1").set_value("first");
+        auto cell = ws.get_cell("A2");
+        cell.set_value("second");
+
+        // the second shared string has a non-zero index which mustn't show through
+        TS_ASSERT(!cell.get_value<bool>());
+        TS_ASSERT_EQUALS(cell.get_value<int>(), 0);
+        TS_ASSERT_EQUALS(cell.get_value<long double>(), 0);
+
+        cell.set_error("#N/A");
+        TS_ASSERT_EQUALS(cell.get_value<int>(), 0);
+    }
+
     void test_formula1()
     {
         auto ws = wb_guess_types.create_sheet();
@@ -21,6 +21,8 @@
 //
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
+#include <limits>
+
 #include <xlnt/worksheet/worksheet.hpp>
 
 #include "cell_impl.hpp"
@@ -29,6 +31,35 @@
 namespace xlnt {
 namespace detail {
 
+cell_extras::cell_extras()
+    : has_hyperlink_(false),
+      is_merged_(false),
+      has_style_(false),
+      style_id_(0)
+{
+}
+
+cell_extras::cell_extras(const cell_extras &rhs)
+{
+    *this = rhs;
+}
+
+cell_extras &cell_extras::operator=(const cell_extras &rhs)
+{
+    formula_ = rhs.formula_;
+    error_ = rhs.error_;
+    has_hyperlink_ = rhs.has_hyperlink_;
+    hyperlink_ = rhs.hyperlink_;
+    is_merged_ = rhs.is_merged_;
+    has_style_ = rhs.has_style_;
+    style_id_ = rhs.style_id_;
+    comment_.reset(rhs.comment_ == nullptr ? nullptr : new comment_impl(*rhs.comment_));
+
+    return *this;
+}
+
+const std::size_t cell_impl::empty_string = std::numeric_limits<std::size_t>::max();
+
 cell_impl::cell_impl() : cell_impl(column_t(1), 1)
 {
 }
@@ -38,18 +69,13 @@ cell_impl::cell_impl(column_t column, row_t row) : cell_impl(nullptr, column, ro
 }
 
 cell_impl::cell_impl(worksheet_impl *parent, column_t column, row_t row)
-    : type_(cell::type::null),
-      parent_(parent),
+    : parent_(parent),
       column_(column),
       row_(row),
       value_numeric_(0),
-      has_hyperlink_(false),
-      is_merged_(false),
-      has_format_(false),
+      type_(cell::type::null),
       format_id_(0),
-      has_style_(false),
-      style_id_(0),
-      comment_(nullptr)
+      has_format_(false)
 {
 }
 
@@ -61,21 +87,32 @@ cell_impl::cell_impl(const cell_impl &rhs)
 cell_impl &cell_impl::operator=(const cell_impl &rhs)
 {
     parent_ = rhs.parent_;
-    value_numeric_ = rhs.value_numeric_;
-    value_text_ = rhs.value_text_;
-    hyperlink_ = rhs.hyperlink_;
-    formula_ = rhs.formula_;
     column_ = rhs.column_;
     row_ = rhs.row_;
-    is_merged_ = rhs.is_merged_;
-    has_hyperlink_ = rhs.has_hyperlink_;
     type_ = rhs.type_;
     format_id_ = rhs.format_id_;
     has_format_ = rhs.has_format_;
 
-    if (rhs.comment_ != nullptr)
+    if (type_ == cell::type::string)
+    {
+        value_string_ = rhs.value_string_;
+    }
+    else
+    {
+        value_numeric_ = rhs.value_numeric_;
+    }
+
+    if (rhs.extras_ == nullptr)
     {
-        comment_.reset(new comment_impl(*rhs.comment_));
+        extras_.reset();
+    }
+    else if (extras_ == nullptr)
+    {
+        extras_.reset(new cell_extras(*rhs.extras_));
+    }
+    else
+    {
+        *extras_ = *rhs.extras_;
     }
 
     return *this;
@@ -86,5 +123,15 @@ cell cell_impl::self()
     return xlnt::cell(this);
 }
 
+cell_extras &cell_impl::extras()
+{
+    if (extras_ == nullptr)
+    {
+        extras_.reset(new cell_extras());
+    }
+
+    return *extras_;
+}
+
 } // namespace detail
 } // namespace xlnt
@@ -22,7 +22,10 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
+#include <memory>
+#include <string>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/text.hpp>
@@ -43,8 +46,43 @@ namespace detail {
 
 struct worksheet_impl;
 
+/// <summary>
+/// Properties that most cells don't have. These are kept out of cell_impl and
+/// only allocated the first time one of them is set on a cell.
+/// </summary>
+struct cell_extras
+{
+    cell_extras();
+    cell_extras(const cell_extras &rhs);
+    cell_extras &operator=(const cell_extras &rhs);
+
+    std::string formula_;
+    std::string error_;
+
+    bool has_hyperlink_;
+    relationship hyperlink_;
+
+    bool is_merged_;
+
+    bool has_style_;
+    std::size_t style_id_;
+
+    std::unique_ptr<comment_impl> comment_;
+};
+
+/// <summary>
+/// The data behind an xlnt::cell. Most cells are a number or a string, so only
+/// the value and format are stored inline. Strings are stored as an index into
+/// the workbook's shared string table and everything else lives in extras_.
+/// </summary>
 struct cell_impl
 {
+    /// <summary>
+    /// The value of value_string_ for a string cell holding the empty string,
+    /// which isn't added to the shared string table.
+    /// </summary>
+    static const std::size_t empty_string;
+
     cell_impl();
     cell_impl(column_t column, row_t row);
     cell_impl(worksheet_impl *parent, column_t column, row_t row);
@@ -53,30 +91,29 @@ struct cell_impl
 
     cell self();
 
-    cell::type type_;
+    /// <summary>
+    /// Return the extra properties of this cell, allocating them if necessary.
+    /// </summary>
+    cell_extras &extras();
 
     worksheet_impl *parent_;
 
     column_t column_;
     row_t row_;
 
-    text value_text_;
-    long double value_numeric_;
+    // type_ determines which member is set
+    union
+    {
+        long double value_numeric_;
+        std::size_t value_string_;
+    };
 
-    std::string formula_;
-
-    bool has_hyperlink_;
-    relationship hyperlink_;
+    std::unique_ptr<cell_extras> extras_;
 
-    bool is_merged_;
-
-    bool has_format_;
-    std::size_t format_id_;
-    
-    bool has_style_;
-    std::size_t style_id_;
+    cell::type type_;
 
-    std::unique_ptr<comment_impl> comment_;
+    std::uint32_t format_id_ : 31;
+    std::uint32_t has_format_ : 1;
 };
 
 } // namespace detail
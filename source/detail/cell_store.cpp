@@ -0,0 +1,282 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#include <algorithm>
+
+#include <detail/cell_store.hpp>
+
+namespace {
+
+// Blocks start small so that sheets with few cells stay cheap and double up to
+// this many cells.
+const std::size_t max_block_size = 4096;
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+cell_store::cell_store() : size_(0), lowest_column_(1), highest_column_(1), last_row_(0)
+{
+}
+
+cell_store::cell_store(const cell_store &other) : cell_store()
+{
+    *this = other;
+}
+
+cell_store &cell_store::operator=(const cell_store &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    clear();
+    reserve(other.rows_.size());
+
+    for (const auto &other_row : other.rows_)
+    {
+        rows_.push_back(row{other_row.index, {}});
+        auto &cells = rows_.back().cells;
+        cells.reserve(other_row.cells.size());
+
+        for (auto other_cell : other_row.cells)
+        {
+            auto new_cell = allocate(other_cell->parent_, other_cell->column_, other_cell->row_);
+            *new_cell = *other_cell;
+            cells.push_back(new_cell);
+        }
+    }
+
+    size_ = other.size_;
+    lowest_column_ = other.lowest_column_;
+    highest_column_ = other.highest_column_;
+
+    return *this;
+}
+
+std::size_t cell_store::lower_bound_row(row_t row) const
+{
+    if (last_row_ < rows_.size() && rows_[last_row_].index == row)
+    {
+        return last_row_;
+    }
+
+    // appending rows in order is the common case when building a sheet
+    if (!rows_.empty() && rows_.back().index < row)
+    {
+        return rows_.size();
+    }
+
+    auto match = std::lower_bound(rows_.begin(), rows_.end(), row,
+        [](const cell_store::row &r, row_t index) { return r.index < index; });
+
+    return static_cast<std::size_t>(match - rows_.begin());
+}
+
+const cell_store::row *cell_store::find_row(row_t row) const
+{
+    auto position = lower_bound_row(row);
+
+    if (position == rows_.size() || rows_[position].index != row)
+    {
+        return nullptr;
+    }
+
+    last_row_ = position;
+
+    return &rows_[position];
+}
+
+cell_impl *cell_store::find(row_t row, column_t column) const
+{
+    auto cells_row = find_row(row);
+
+    if (cells_row == nullptr)
+    {
+        return nullptr;
+    }
+
+    const auto &cells = cells_row->cells;
+
+    if (!cells.empty() && cells.back()->column_ == column)
+    {
+        return cells.back();
+    }
+
+    auto match = std::lower_bound(cells.begin(), cells.end(), column,
+        [](const cell_impl *c, const column_t &index) { return c->column_ < index; });
+
+    if (match == cells.end() || (*match)->column_ != column)
+    {
+        return nullptr;
+    }
+
+    return *match;
+}
+
+cell_impl &cell_store::get(worksheet_impl *parent, row_t row, column_t column)
+{
+    auto position = lower_bound_row(row);
+
+    if (position == rows_.size() || rows_[position].index != row)
+    {
+        rows_.insert(rows_.begin() + static_cast<std::ptrdiff_t>(position), cell_store::row{row, {}});
+    }
+
+    last_row_ = position;
+    auto &cells = rows_[position].cells;
+
+    // cells are usually created left to right
+    if (cells.empty() || cells.back()->column_ < column)
+    {
+        cells.push_back(allocate(parent, column, row));
+        ++size_;
+
+        return *cells.back();
+    }
+
+    auto match = std::lower_bound(cells.begin(), cells.end(), column,
+        [](const cell_impl *c, const column_t &index) { return c->column_ < index; });
+
+    if ((*match)->column_ != column)
+    {
+        match = cells.insert(match, allocate(parent, column, row));
+        ++size_;
+    }
+
+    return **match;
+}
+
+void cell_store::clear()
+{
+    rows_.clear();
+    blocks_.clear();
+    free_cells_.clear();
+    size_ = 0;
+    lowest_column_ = 1;
+    highest_column_ = 1;
+    last_row_ = 0;
+}
+
+void cell_store::reserve(std::size_t rows)
+{
+    rows_.reserve(rows);
+}
+
+bool cell_store::empty() const
+{
+    return rows_.empty();
+}
+
+std::size_t cell_store::size() const
+{
+    return size_;
+}
+
+column_t cell_store::lowest_column() const
+{
+    return lowest_column_;
+}
+
+column_t cell_store::highest_column() const
+{
+    return highest_column_;
+}
+
+cell_store::const_iterator cell_store::begin() const
+{
+    return rows_.begin();
+}
+
+cell_store::const_iterator cell_store::end() const
+{
+    return rows_.end();
+}
+
+cell_impl *cell_store::allocate(worksheet_impl *parent, column_t column, row_t row)
+{
+    if (size_ == 0)
+    {
+        lowest_column_ = column;
+        highest_column_ = column;
+    }
+    else
+    {
+        lowest_column_ = std::min(lowest_column_, column);
+        highest_column_ = std::max(highest_column_, column);
+    }
+
+    if (!free_cells_.empty())
+    {
+        auto cell = free_cells_.back();
+        free_cells_.pop_back();
+        *cell = cell_impl(parent, column, row);
+
+        return cell;
+    }
+
+    if (blocks_.empty() || blocks_.back().size() == blocks_.back().capacity())
+    {
+        auto block_size = blocks_.empty() ? std::size_t(16) : std::min(max_block_size, blocks_.back().capacity() * 2);
+        blocks_.emplace_back();
+        blocks_.back().reserve(block_size);
+    }
+
+    // the block never grows past its reserved capacity so this doesn't move other cells
+    blocks_.back().emplace_back(parent, column, row);
+
+    return &blocks_.back().back();
+}
+
+void cell_store::update_column_bounds()
+{
+    if (rows_.empty())
+    {
+        lowest_column_ = 1;
+        highest_column_ = 1;
+
+        return;
+    }
+
+    lowest_column_ = rows_.front().cells.front()->column_;
+    highest_column_ = rows_.front().cells.back()->column_;
+
+    // cells in a row are sorted by column so only the ends of each row matter
+    for (const auto &current_row : rows_)
+    {
+        lowest_column_ = std::min(lowest_column_, current_row.cells.front()->column_);
+        highest_column_ = std::max(highest_column_, current_row.cells.back()->column_);
+    }
+}
+
+void cell_store::release(cell_impl *cell)
+{
+    cell->extras_.reset();
+    free_cells_.push_back(cell);
+    --size_;
+}
+
+} // namespace detail
+} // namespace xlnt
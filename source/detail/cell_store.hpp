@@ -0,0 +1,154 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <detail/cell_impl.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+namespace detail {
+
+struct worksheet_impl;
+
+/// <summary>
+/// Holds the cells of a worksheet. Rows are kept in a vector sorted by row index
+/// and each row holds its cells sorted by column, so visiting a sheet in row-major
+/// order is a sequential walk. The cells themselves live in blocks which are never
+/// reallocated, so a cell's address stays valid until it is erased, which
+/// xlnt::cell relies on.
+/// </summary>
+class cell_store
+{
+public:
+    struct row
+    {
+        row_t index;
+        std::vector<cell_impl *> cells;
+    };
+
+    using const_iterator = std::vector<row>::const_iterator;
+
+    cell_store();
+    cell_store(const cell_store &other);
+    cell_store &operator=(const cell_store &other);
+
+    /// <summary>
+    /// Return the cell at the given row and column or nullptr if it doesn't exist.
+    /// </summary>
+    cell_impl *find(row_t row, column_t column) const;
+
+    /// <summary>
+    /// Return the row with the given index or nullptr if it has no cells.
+    /// </summary>
+    const row *find_row(row_t row) const;
+
+    /// <summary>
+    /// Return the cell at the given row and column, creating it with parent if it
+    /// doesn't exist.
+    /// </summary>
+    cell_impl &get(worksheet_impl *parent, row_t row, column_t column);
+
+    /// <summary>
+    /// Remove every cell for which predicate returns true along with rows left empty.
+    /// </summary>
+    template <typename Predicate>
+    void erase_if(Predicate predicate)
+    {
+        auto row_iter = rows_.begin();
+
+        for (auto &current_row : rows_)
+        {
+            auto cell_iter = current_row.cells.begin();
+
+            for (auto current_cell : current_row.cells)
+            {
+                if (predicate(*current_cell))
+                {
+                    release(current_cell);
+                }
+                else
+                {
+                    *cell_iter++ = current_cell;
+                }
+            }
+
+            current_row.cells.erase(cell_iter, current_row.cells.end());
+
+            if (!current_row.cells.empty())
+            {
+                if (&*row_iter != &current_row)
+                {
+                    *row_iter = std::move(current_row);
+                }
+
+                ++row_iter;
+            }
+        }
+
+        rows_.erase(row_iter, rows_.end());
+        last_row_ = 0;
+        update_column_bounds();
+    }
+
+    void clear();
+    void reserve(std::size_t rows);
+
+    bool empty() const;
+    std::size_t size() const;
+
+    /// <summary>
+    /// Return the lowest and highest column of any cell in the store. These are
+    /// kept up to date as cells are added and erased so they don't require a scan.
+    /// They are only meaningful if the store isn't empty.
+    /// </summary>
+    column_t lowest_column() const;
+    column_t highest_column() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    cell_impl *allocate(worksheet_impl *parent, column_t column, row_t row);
+    void release(cell_impl *cell);
+    void update_column_bounds();
+    std::size_t lower_bound_row(row_t row) const;
+
+    std::vector<row> rows_;
+    std::vector<std::vector<cell_impl>> blocks_;
+    std::vector<cell_impl *> free_cells_;
+    std::size_t size_;
+    column_t lowest_column_;
+    column_t highest_column_;
+
+    // index into rows_ of the last row found, since cells are usually accessed
+    // many times in one row before moving on to the next
+    mutable std::size_t last_row_;
+};
+
+} // namespace detail
+} // namespace xlnt
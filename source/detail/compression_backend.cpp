@@ -0,0 +1,330 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#if defined(XLNT_LIBDEFLATE)
+#include <libdeflate.h>
+#elif defined(XLNT_ZLIB_NG)
+#include <zlib-ng.h>
+#else
+#include <miniz.h>
+#endif
+
+#include <detail/compression_backend.hpp>
+
+namespace {
+
+#if defined(XLNT_LIBDEFLATE)
+
+int to_backend_level(xlnt::compression_level level)
+{
+    switch (level)
+    {
+    case xlnt::compression_level::fast:
+        return 1;
+    case xlnt::compression_level::normal:
+        return 6;
+    case xlnt::compression_level::best:
+    default:
+        // levels above 9 switch to near-optimal parsing, which is many times slower for very little gain
+        return 9;
+    }
+}
+
+#elif defined(XLNT_ZLIB_NG)
+
+int to_backend_level(xlnt::compression_level level)
+{
+    switch (level)
+    {
+    case xlnt::compression_level::fast:
+        return Z_BEST_SPEED;
+    case xlnt::compression_level::normal:
+        return Z_DEFAULT_COMPRESSION;
+    case xlnt::compression_level::best:
+    default:
+        return Z_BEST_COMPRESSION;
+    }
+}
+
+#else
+
+int to_backend_level(xlnt::compression_level level)
+{
+    switch (level)
+    {
+    case xlnt::compression_level::fast:
+        return MZ_BEST_SPEED;
+    case xlnt::compression_level::normal:
+        return MZ_DEFAULT_LEVEL;
+    case xlnt::compression_level::best:
+    default:
+        return MZ_BEST_COMPRESSION;
+    }
+}
+
+/// <summary>
+/// Lookup tables for slice-by-8 CRC-32. table[0] is the usual bytewise table
+/// and table[n] advances a byte's CRC over n more zero bytes, so eight input
+/// bytes can be folded into the CRC with eight independent lookups.
+/// </summary>
+struct crc32_tables
+{
+    crc32_tables()
+    {
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            auto crc = i;
+
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+            }
+
+            table[0][i] = crc;
+        }
+
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            for (std::size_t slice = 1; slice < 8; ++slice)
+            {
+                table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xFF];
+            }
+        }
+    }
+
+    std::uint32_t table[8][256];
+};
+
+const crc32_tables &get_crc32_tables()
+{
+    static const crc32_tables tables;
+    return tables;
+}
+
+mz_bool put_compressed(const void *data, int size, void *user)
+{
+    auto compressed = static_cast<std::vector<char> *>(user);
+    auto bytes = static_cast<const char *>(data);
+    compressed->insert(compressed->end(), bytes, bytes + size);
+
+    return MZ_TRUE;
+}
+
+#endif
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+#if defined(XLNT_LIBDEFLATE)
+
+const char *compression_backend()
+{
+    return "libdeflate";
+}
+
+std::uint32_t compute_crc32(std::uint32_t crc, const void *data, std::size_t size)
+{
+    return libdeflate_crc32(crc, data, size);
+}
+
+void deflate_bytes(const void *data, std::size_t size, compression_level level, std::vector<char> &compressed)
+{
+    std::unique_ptr<libdeflate_compressor, void (*)(libdeflate_compressor *)> compressor(
+        libdeflate_alloc_compressor(to_backend_level(level)), &libdeflate_free_compressor);
+
+    if (!compressor)
+    {
+        throw std::runtime_error("couldn't initialize deflate");
+    }
+
+    auto offset = compressed.size();
+    auto bound = libdeflate_deflate_compress_bound(compressor.get(), size);
+    compressed.resize(offset + bound);
+
+    auto compressed_size = libdeflate_deflate_compress(compressor.get(), data, size, compressed.data() + offset, bound);
+
+    if (compressed_size == 0)
+    {
+        throw std::runtime_error("couldn't deflate");
+    }
+
+    compressed.resize(offset + compressed_size);
+}
+
+bool inflate_bytes(const void *data, std::size_t size, void *destination, std::size_t uncompressed_size)
+{
+    std::unique_ptr<libdeflate_decompressor, void (*)(libdeflate_decompressor *)> decompressor(
+        libdeflate_alloc_decompressor(), &libdeflate_free_decompressor);
+
+    if (!decompressor)
+    {
+        throw std::runtime_error("couldn't initialize inflate");
+    }
+
+    // without an actual_out_nbytes_ret the output has to be filled exactly
+    return libdeflate_deflate_decompress(decompressor.get(), data, size, destination, uncompressed_size, nullptr)
+        == LIBDEFLATE_SUCCESS;
+}
+
+#elif defined(XLNT_ZLIB_NG)
+
+const char *compression_backend()
+{
+    return "zlib-ng";
+}
+
+std::uint32_t compute_crc32(std::uint32_t crc, const void *data, std::size_t size)
+{
+    return static_cast<std::uint32_t>(zng_crc32_z(crc, static_cast<const std::uint8_t *>(data), size));
+}
+
+void deflate_bytes(const void *data, std::size_t size, compression_level level, std::vector<char> &compressed)
+{
+    if (size > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::runtime_error("member is too large to deflate");
+    }
+
+    zng_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+
+    if (zng_deflateInit2(&stream, to_backend_level(level), Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw std::runtime_error("couldn't initialize deflate");
+    }
+
+    auto offset = compressed.size();
+    auto bound = zng_deflateBound(&stream, static_cast<unsigned long>(size));
+    compressed.resize(offset + bound);
+
+    stream.next_in = static_cast<const std::uint8_t *>(data);
+    stream.avail_in = static_cast<std::uint32_t>(size);
+    stream.next_out = reinterpret_cast<std::uint8_t *>(compressed.data() + offset);
+    stream.avail_out = static_cast<std::uint32_t>(bound);
+
+    auto result = zng_deflate(&stream, Z_FINISH);
+    auto compressed_size = static_cast<std::size_t>(stream.total_out);
+    zng_deflateEnd(&stream);
+
+    if (result != Z_STREAM_END)
+    {
+        throw std::runtime_error("couldn't deflate");
+    }
+
+    compressed.resize(offset + compressed_size);
+}
+
+bool inflate_bytes(const void *data, std::size_t size, void *destination, std::size_t uncompressed_size)
+{
+    if (size > std::numeric_limits<std::uint32_t>::max()
+        || uncompressed_size > std::numeric_limits<std::uint32_t>::max())
+    {
+        return false;
+    }
+
+    zng_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+
+    if (zng_inflateInit2(&stream, -15) != Z_OK)
+    {
+        throw std::runtime_error("couldn't initialize inflate");
+    }
+
+    stream.next_in = static_cast<const std::uint8_t *>(data);
+    stream.avail_in = static_cast<std::uint32_t>(size);
+    stream.next_out = static_cast<std::uint8_t *>(destination);
+    stream.avail_out = static_cast<std::uint32_t>(uncompressed_size);
+
+    auto result = zng_inflate(&stream, Z_FINISH);
+    auto inflated_size = static_cast<std::size_t>(stream.total_out);
+    zng_inflateEnd(&stream);
+
+    return result == Z_STREAM_END && inflated_size == uncompressed_size;
+}
+
+#else
+
+const char *compression_backend()
+{
+    return "miniz";
+}
+
+std::uint32_t compute_crc32(std::uint32_t crc, const void *data, std::size_t size)
+{
+    const auto &table = get_crc32_tables().table;
+    auto bytes = static_cast<const unsigned char *>(data);
+
+    crc = ~crc;
+
+    // assembled bytewise so this doesn't depend on alignment or byte order
+    while (size >= 8)
+    {
+        auto low = crc
+            ^ (static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8
+                | static_cast<std::uint32_t>(bytes[2]) << 16 | static_cast<std::uint32_t>(bytes[3]) << 24);
+
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF]
+            ^ table[4][low >> 24] ^ table[3][bytes[4]] ^ table[2][bytes[5]] ^ table[1][bytes[6]]
+            ^ table[0][bytes[7]];
+
+        bytes += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0)
+    {
+        crc = (crc >> 8) ^ table[0][(crc ^ *bytes++) & 0xFF];
+    }
+
+    return ~crc;
+}
+
+// compressed the same way as mz_zip_writer_add_mem_ex so the result is identical
+void deflate_bytes(const void *data, std::size_t size, compression_level level, std::vector<char> &compressed)
+{
+    std::unique_ptr<tdefl_compressor> compressor(new tdefl_compressor);
+    auto flags = tdefl_create_comp_flags_from_zip_params(to_backend_level(level), -15, MZ_DEFAULT_STRATEGY);
+
+    if (tdefl_init(compressor.get(), &put_compressed, &compressed, static_cast<int>(flags)) != TDEFL_STATUS_OKAY
+        || tdefl_compress_buffer(compressor.get(), data, size, TDEFL_FINISH) != TDEFL_STATUS_DONE)
+    {
+        throw std::runtime_error("couldn't deflate");
+    }
+}
+
+bool inflate_bytes(const void *data, std::size_t size, void *destination, std::size_t uncompressed_size)
+{
+    return tinfl_decompress_mem_to_mem(destination, uncompressed_size, data, size, 0) == uncompressed_size;
+}
+
+#endif
+
+} // namespace detail
+} // namespace xlnt
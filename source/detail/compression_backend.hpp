@@ -0,0 +1,61 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <xlnt/packaging/compression_level.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Return the name of the library zip members are deflated and inflated with.
+/// This is chosen when xlnt is built. XLNT_LIBDEFLATE selects libdeflate,
+/// XLNT_ZLIB_NG selects zlib-ng and the bundled miniz is used otherwise.
+/// </summary>
+const char *compression_backend();
+
+/// <summary>
+/// Continue crc, the CRC-32 used by zip, over size bytes at data. Start from 0.
+/// </summary>
+std::uint32_t compute_crc32(std::uint32_t crc, const void *data, std::size_t size);
+
+/// <summary>
+/// Deflate size bytes at data into a raw deflate stream which is appended to
+/// compressed. level must not be compression_level::store.
+/// </summary>
+void deflate_bytes(const void *data, std::size_t size, compression_level level, std::vector<char> &compressed);
+
+/// <summary>
+/// Inflate the raw deflate stream of size bytes at data into exactly
+/// uncompressed_size bytes at destination. Returns false if the stream is
+/// corrupt or doesn't inflate to that size.
+/// </summary>
+bool inflate_bytes(const void *data, std::size_t size, void *destination, std::size_t uncompressed_size);
+
+} // namespace detail
+} // namespace xlnt
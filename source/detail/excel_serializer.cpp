@@ -22,8 +22,14 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
 #include <iterator>
+#include <memory>
 #include <pugixml.hpp>
+#include <thread>
+#include <utility>
 
 #include <detail/constants.hpp>
 #include <detail/excel_serializer.hpp>
@@ -35,7 +41,9 @@
 #include <detail/theme_serializer.hpp>
 #include <detail/workbook_impl.hpp>
 #include <detail/workbook_serializer.hpp>
+#include <detail/worksheet_sax_handler.hpp>
 #include <detail/worksheet_serializer.hpp>
+#include <detail/xml_sax_parser.hpp>
 #include <xlnt/cell/text.hpp>
 #include <xlnt/packaging/document_properties.hpp>
 #include <xlnt/packaging/manifest.hpp>
@@ -66,8 +74,187 @@ std::string::size_type find_string_in_string(const std::string &string, const st
     return possible_match_index;
 }
 
-bool load_workbook(xlnt::zip_file &archive, bool guess_types, bool data_only, xlnt::workbook &wb, xlnt::detail::stylesheet &stylesheet)
+/// <summary>
+/// Parse the given worksheet parts into the sheets with the given titles on a
+/// pool of threads. Handlers don't modify the workbook while threads are running
+/// so the changes they hold are made afterwards, one sheet at a time in order.
+/// </summary>
+void read_worksheets_parallel(xlnt::zip_file &archive, xlnt::workbook &wb,
+    const std::vector<std::pair<std::string, std::string>> &sheets, xlnt::detail::stylesheet &stylesheet)
 {
+    std::vector<std::unique_ptr<xlnt::detail::worksheet_sax_handler>> handlers;
+
+    for (const auto &sheet : sheets)
+    {
+        handlers.emplace_back(new xlnt::detail::worksheet_sax_handler(wb.get_sheet_by_name(sheet.first), stylesheet));
+        handlers.back()->defer_workbook_changes();
+    }
+
+    std::atomic<std::size_t> next_sheet(0);
+    std::vector<std::exception_ptr> errors(sheets.size());
+
+    auto read_sheets = [&]()
+    {
+        for (auto i = next_sheet++; i < sheets.size(); i = next_sheet++)
+        {
+            try
+            {
+                xlnt::detail::xml_sax_parser parser(*handlers[i]);
+                archive.read(sheets[i].second, [&parser](const char *data, std::size_t size) { parser.feed(data, size); });
+                parser.finish();
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    auto thread_count = std::min<std::size_t>(sheets.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+
+    // the calling thread reads sheets too
+    for (std::size_t i = 1; i < thread_count; i++)
+    {
+        threads.emplace_back(read_sheets);
+    }
+
+    read_sheets();
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<std::size_t> format_ids;
+
+    for (std::size_t i = 0; i < sheets.size(); i++)
+    {
+        if (errors[i])
+        {
+            std::rethrow_exception(errors[i]);
+        }
+
+        handlers[i]->apply_workbook_changes(format_ids);
+    }
+}
+
+/// <summary>
+/// Return true if the worksheet at part of archive can be copied to another
+/// package on its own. Parts it has relationships to, like printer settings,
+/// drawings and comments, aren't written when a workbook is saved and neither
+/// are the differential formats conditional formatting refers to, so a copy of
+/// a sheet using them would be left with dangling references.
+/// </summary>
+bool is_self_contained_worksheet(xlnt::zip_file &archive, const std::string &part)
+{
+    auto separator = part.find_last_of('/');
+    auto rels_part = part.substr(0, separator + 1) + "_rels/" + part.substr(separator + 1) + ".rels";
+
+    if (archive.has_file(rels_part))
+    {
+        return false;
+    }
+
+    const std::vector<std::string> dependencies = { "conditionalFormatting", "dxfId" };
+    const std::size_t longest = std::string("conditionalFormatting").size();
+
+    // the end of each chunk is kept in case a name is split between two of them
+    std::string window;
+    bool found = false;
+
+    archive.read(part, [&](const char *data, std::size_t size)
+    {
+        if (found)
+        {
+            return;
+        }
+
+        window.append(data, size);
+
+        for (const auto &dependency : dependencies)
+        {
+            if (window.find(dependency) != std::string::npos)
+            {
+                found = true;
+                return;
+            }
+        }
+
+        window.erase(0, window.size() - std::min(window.size(), longest - 1));
+    });
+
+    return !found;
+}
+
+// Remove the formats no cell or column of wb uses, giving the rest new ids in
+// the order they're first found, in one pass over the cells.
+void compact_styles(xlnt::detail::workbook_impl &wb)
+{
+    for (const auto &ws : wb.worksheets_)
+    {
+        // these sheets are written with the format ids they had when they were read or appended
+        if (!ws.source_part_.empty() || !ws.unmodified_part_.empty() || ws.row_writer_)
+        {
+            return;
+        }
+    }
+
+    auto &stylesheet = wb.stylesheet_;
+    const auto unassigned = stylesheet.formats.size();
+    std::vector<std::size_t> new_ids(stylesheet.formats.size(), unassigned);
+    std::vector<std::size_t> kept_formats;
+
+    auto new_id = [&](std::size_t old_id)
+    {
+        if (old_id >= new_ids.size())
+        {
+            return old_id;
+        }
+
+        if (new_ids[old_id] == unassigned)
+        {
+            new_ids[old_id] = kept_formats.size();
+            kept_formats.push_back(old_id);
+        }
+
+        return new_ids[old_id];
+    };
+
+    // the default format is used by every cell without a format
+    if (!stylesheet.formats.empty())
+    {
+        new_id(0);
+    }
+
+    for (auto &ws : wb.worksheets_)
+    {
+        for (const auto &row : ws.cells_)
+        {
+            for (auto cell : row.cells)
+            {
+                cell->format_id_ = cell->has_format_ ? static_cast<std::uint32_t>(new_id(cell->format_id_)) : 0;
+            }
+        }
+
+        for (auto &column : ws.column_properties_)
+        {
+            column.second.style = new_id(column.second.style);
+        }
+    }
+
+    stylesheet.compact(kept_formats);
+}
+
+} // namespace
+
+namespace xlnt {
+
+bool excel_serializer::read_archive(zip_file &archive, bool guess_types, bool data_only)
+{
+    auto &wb = workbook_;
+    auto &stylesheet = get_stylesheet();
+
     wb.set_guess_types(guess_types);
     wb.set_data_only(data_only);
 
@@ -148,6 +335,11 @@ bool load_workbook(xlnt::zip_file &archive, bool guess_types, bool data_only, xl
 	style_xml.load(archive.read(xlnt::constants::part_styles()).c_str());
     style_serializer.read_stylesheet(style_xml);
 
+    auto read_only = wb.get_read_only();
+    auto parallel = wb.get_parallel_load() && !read_only;
+    std::vector<std::pair<std::string, std::string>> parallel_sheets;
+    std::vector<std::pair<std::string, std::string>> loaded_sheets;
+
     for (auto sheet_node : root_node.child("sheets").children())
     {
         auto rel = wb.get_relationship(sheet_node.attribute("r:id").value());
@@ -158,12 +350,44 @@ bool load_workbook(xlnt::zip_file &archive, bool guess_types, bool data_only, xl
             continue;
         }
 
-        auto ws = wb.create_sheet(sheet_node.attribute("name").value());
+        auto ws = wb.add_sheet(wb.validate_sheet_title(sheet_node.attribute("name").value()));
+
         xlnt::worksheet_serializer worksheet_serializer(ws);
-		pugi::xml_document worksheet_xml;
-		worksheet_xml.load(archive.read("xl/" + rel.get_target_uri()).c_str());
+        auto part = "xl/" + rel.get_target_uri();
 
-        worksheet_serializer.read_worksheet(worksheet_xml, stylesheet);
+        if (read_only)
+        {
+            worksheet_serializer.defer_worksheet(part);
+        }
+        else if (parallel)
+        {
+            // sheets are read once they've all been created since creating a
+            // sheet moves the others
+            parallel_sheets.push_back({ ws.get_title(), part });
+        }
+        else
+        {
+            worksheet_serializer.read_worksheet(archive, part, stylesheet);
+        }
+
+        loaded_sheets.push_back({ ws.get_title(), part });
+    }
+
+    if (!parallel_sheets.empty())
+    {
+        read_worksheets_parallel(archive, wb, parallel_sheets, stylesheet);
+    }
+
+    // reading a sheet modifies it so sheets are only marked once they've all been read
+    if (wb.get_copy_unmodified_sheets())
+    {
+        for (auto &loaded : loaded_sheets)
+        {
+            if (is_self_contained_worksheet(archive, loaded.second))
+            {
+                xlnt::worksheet_serializer(wb.get_sheet_by_name(loaded.first)).mark_unmodified(loaded.second);
+            }
+        }
     }
 
     if (archive.has_file("docProps/thumbnail.jpeg"))
@@ -175,10 +399,6 @@ bool load_workbook(xlnt::zip_file &archive, bool guess_types, bool data_only, xl
     return true;
 }
 
-} // namespace
-
-namespace xlnt {
-
 const std::string excel_serializer::central_directory_signature()
 {
     return "\x50\x4b\x05\x06";
@@ -198,36 +418,50 @@ std::string excel_serializer::repair_central_directory(const std::string &origin
 
 bool excel_serializer::load_stream_workbook(std::istream &stream, bool guess_types, bool data_only)
 {
-    std::vector<std::uint8_t> bytes;
-    
-    //TODO: inefficient?
-    while (stream.good())
-    {
-        bytes.push_back(static_cast<std::uint8_t>(stream.get()));
-    }
-    
-    return load_virtual_workbook(bytes, guess_types, data_only);
+    // the archive reads the stream into its own buffer in large blocks
+    auto &archive = get_source_archive();
+    archive.load(stream);
+
+    return read_archive(archive, guess_types, data_only);
 }
 
 bool excel_serializer::load_workbook(const std::string &filename, bool guess_types, bool data_only)
 {
+    auto &archive = get_source_archive();
+
     try
     {
-        archive_.load(filename);
+        archive.load(filename);
     }
     catch (std::runtime_error)
     {
         throw invalid_file_error(filename);
     }
 
-    return ::load_workbook(archive_, guess_types, data_only, workbook_, get_stylesheet());
+    return read_archive(archive, guess_types, data_only);
 }
 
 bool excel_serializer::load_virtual_workbook(const std::vector<std::uint8_t> &bytes, bool guess_types, bool data_only)
 {
-    archive_.load(bytes);
+    auto &archive = get_source_archive();
+    archive.load(bytes);
+
+    return read_archive(archive, guess_types, data_only);
+}
+
+zip_file &excel_serializer::get_source_archive()
+{
+    if (!workbook_.get_read_only() && !workbook_.get_copy_unmodified_sheets())
+    {
+        return archive_;
+    }
+
+    // Worksheets of read-only workbooks are streamed from the archive after
+    // loading and unmodified worksheets are copied from it when saving, so it
+    // is owned by the workbook rather than this serializer.
+    workbook_.d_->archive_ = std::make_shared<zip_file>();
 
-    return ::load_workbook(archive_, guess_types, data_only, workbook_, get_stylesheet());
+    return *workbook_.d_->archive_;
 }
 
 excel_serializer::excel_serializer(workbook &wb) : workbook_(wb)
@@ -236,6 +470,24 @@ excel_serializer::excel_serializer(workbook &wb) : workbook_(wb)
 
 void excel_serializer::write_data(bool /*as_template*/)
 {
+    archive_.set_compression_level(workbook_.d_->compression_level_);
+    archive_.set_parallel_compression(workbook_.d_->parallel_save_);
+
+    for (const auto &part_level : workbook_.d_->part_compression_levels_)
+    {
+        archive_.set_compression_level(part_level.first, part_level.second);
+    }
+
+    if (workbook_.get_compact_styles())
+    {
+        compact_styles(*workbook_.d_);
+    }
+
+    // Cells of streamed worksheets are read again as they're written and their
+    // strings added to the shared string table, so worksheets go before the
+    // table and the relationships and content types which refer to it.
+    write_worksheets();
+
     relationship_serializer relationship_serializer_(archive_);
     relationship_serializer_.write_relationships(workbook_.get_root_relationships(), "");
     relationship_serializer_.write_relationships(workbook_.get_relationships(), constants::part_workbook());
@@ -309,8 +561,6 @@ void excel_serializer::write_data(bool /*as_template*/)
         archive_.writestr(constants::part_content_types(), ss.str());
     }
 
-    write_worksheets();
-
     if(!workbook_.get_thumbnail().empty())
     {
         const auto &thumbnail = workbook_.get_thumbnail();
@@ -331,11 +581,12 @@ void excel_serializer::write_worksheets()
             {
                 worksheet_serializer serializer_(ws);
                 std::string ws_filename = (relationship.get_target_uri().substr(0, 3) != "xl/" ? "xl/" : "") + relationship.get_target_uri();
-                std::ostringstream ss;
-                pugi::xml_document worksheet_xml;
-                serializer_.write_worksheet(worksheet_xml);
-                worksheet_xml.save(ss);
-                archive_.writestr(ws_filename, ss.str());
+                auto source = workbook_.d_->archive_.get();
+
+                if (source == nullptr || !serializer_.copy_worksheet(*source, archive_, ws_filename))
+                {
+                    serializer_.write_worksheet(archive_, ws_filename);
+                }
 
                 break;
             }
@@ -351,6 +602,8 @@ void excel_serializer::write_external_links()
 
 bool excel_serializer::save_stream_workbook(std::ostream &stream, bool as_template)
 {
+    // parts go straight to stream as they're written rather than into a buffer first
+    archive_.begin_save(stream);
     write_data(as_template);
     archive_.save(stream);
 
@@ -359,14 +612,21 @@ bool excel_serializer::save_stream_workbook(std::ostream &stream, bool as_templa
 
 bool excel_serializer::save_workbook(const std::string &filename, bool as_template)
 {
-    write_data(as_template);
-    archive_.save(filename);
+    // worksheets of a read-only workbook are still read from the file it was loaded from,
+    // which filename may name by a different path
+    if (workbook_.d_->archive_ && workbook_.d_->archive_->is_mapped_from(filename))
+    {
+        workbook_.d_->archive_->release_file();
+    }
 
-    return true;
+    std::ofstream stream(filename, std::ios::binary);
+
+    return save_stream_workbook(stream, as_template);
 }
 
 bool excel_serializer::save_virtual_workbook(std::vector<std::uint8_t> &bytes, bool as_template)
 {
+    archive_.begin_save(bytes);
     write_data(as_template);
     archive_.save(bytes);
 
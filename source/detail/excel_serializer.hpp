@@ -104,6 +104,11 @@ private:
     /// </summary>
     void read_data(bool guess_types, bool data_only);
 
+    /// <summary>
+    /// Populate the workbook from archive, which has just been loaded.
+    /// </summary>
+    bool read_archive(zip_file &archive, bool guess_types, bool data_only);
+
     /// <summary>
     /// Read xl/sharedStrings.xml from internal archive and add shared strings to workbook.
     /// </summary>
@@ -119,6 +124,12 @@ private:
     /// </summary>
     void read_charts();
 
+    /// <summary>
+    /// Return the archive to load into. This is archive_ unless the workbook is
+    /// read-only, in which case the workbook keeps the archive for streaming.
+    /// </summary>
+    zip_file &get_source_archive();
+
     /// <summary>
     ///
     /// </summary>
@@ -0,0 +1,224 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/styles/protection.hpp>
+#include <xlnt/utils/hash_combine.hpp>
+
+#include <detail/format_builder.hpp>
+
+namespace xlnt {
+namespace detail {
+
+format_builder::format_builder(const format &base)
+    : base_(base),
+      alignment_(nullptr),
+      border_(nullptr),
+      fill_(nullptr),
+      font_(nullptr),
+      number_format_(nullptr),
+      protection_(nullptr)
+{
+}
+
+format_builder &format_builder::set_alignment(const alignment &new_alignment)
+{
+    alignment_ = &new_alignment;
+    return *this;
+}
+
+format_builder &format_builder::set_border(const border &new_border)
+{
+    border_ = &new_border;
+    return *this;
+}
+
+format_builder &format_builder::set_fill(const fill &new_fill)
+{
+    fill_ = &new_fill;
+    return *this;
+}
+
+format_builder &format_builder::set_font(const font &new_font)
+{
+    font_ = &new_font;
+    return *this;
+}
+
+format_builder &format_builder::set_number_format(const number_format &new_number_format)
+{
+    number_format_ = &new_number_format;
+    return *this;
+}
+
+format_builder &format_builder::set_protection(const protection &new_protection)
+{
+    // base_format::set_protection ignores the default protection
+    if (!new_protection.get_locked() || new_protection.get_hidden())
+    {
+        protection_ = &new_protection;
+    }
+
+    return *this;
+}
+
+bool format_builder::alignment_applied() const
+{
+    return alignment_ != nullptr || base_.alignment_applied();
+}
+
+bool format_builder::border_applied() const
+{
+    return border_ != nullptr || base_.border_applied();
+}
+
+bool format_builder::fill_applied() const
+{
+    return fill_ != nullptr || base_.fill_applied();
+}
+
+bool format_builder::font_applied() const
+{
+    return font_ != nullptr || base_.font_applied();
+}
+
+bool format_builder::number_format_applied() const
+{
+    return number_format_ != nullptr || base_.number_format_applied();
+}
+
+bool format_builder::protection_applied() const
+{
+    return protection_ != nullptr || base_.protection_applied();
+}
+
+const alignment &format_builder::get_alignment() const
+{
+    return alignment_ != nullptr ? *alignment_ : base_.get_alignment();
+}
+
+const border &format_builder::get_border() const
+{
+    return border_ != nullptr ? *border_ : base_.get_border();
+}
+
+const fill &format_builder::get_fill() const
+{
+    return fill_ != nullptr ? *fill_ : base_.get_fill();
+}
+
+const font &format_builder::get_font() const
+{
+    return font_ != nullptr ? *font_ : base_.get_font();
+}
+
+const number_format &format_builder::get_number_format() const
+{
+    return number_format_ != nullptr ? *number_format_ : base_.get_number_format();
+}
+
+const protection &format_builder::get_protection() const
+{
+    return protection_ != nullptr ? *protection_ : base_.get_protection();
+}
+
+std::size_t format_builder::hash() const
+{
+    std::size_t seed = 0;
+
+    // this has to combine the same values in the same order as base_format::hash
+    hash_combine(seed, alignment_applied());
+    hash_combine(seed, alignment_applied() ? get_alignment().hash() : 0);
+    hash_combine(seed, border_applied());
+    hash_combine(seed, border_applied() ? get_border().hash() : 0);
+    hash_combine(seed, font_applied());
+    hash_combine(seed, font_applied() ? get_font().hash() : 0);
+    hash_combine(seed, fill_applied());
+    hash_combine(seed, fill_applied() ? get_fill().hash() : 0);
+    hash_combine(seed, number_format_applied());
+    hash_combine(seed, get_number_format().hash());
+    hash_combine(seed, protection_applied());
+    hash_combine(seed, protection_applied() ? get_protection().hash() : 0);
+
+    return seed;
+}
+
+bool format_builder::operator==(const format &other) const
+{
+    return alignment_applied() == other.alignment_applied()
+        && border_applied() == other.border_applied()
+        && fill_applied() == other.fill_applied()
+        && font_applied() == other.font_applied()
+        && number_format_applied() == other.number_format_applied()
+        && protection_applied() == other.protection_applied()
+        && (!alignment_applied() || get_alignment() == other.get_alignment())
+        && (!border_applied() || get_border() == other.get_border())
+        && (!fill_applied() || get_fill() == other.get_fill())
+        && (!font_applied() || get_font() == other.get_font())
+        && get_number_format() == other.get_number_format()
+        && (!protection_applied() || get_protection() == other.get_protection());
+}
+
+format format_builder::build() const
+{
+    format result(base_);
+
+    if (alignment_ != nullptr)
+    {
+        result.set_alignment(*alignment_);
+    }
+
+    if (border_ != nullptr)
+    {
+        result.set_border(*border_);
+    }
+
+    if (fill_ != nullptr)
+    {
+        result.set_fill(*fill_);
+    }
+
+    if (font_ != nullptr)
+    {
+        result.set_font(*font_);
+    }
+
+    if (number_format_ != nullptr)
+    {
+        result.set_number_format(*number_format_);
+    }
+
+    if (protection_ != nullptr)
+    {
+        result.set_protection(*protection_);
+    }
+
+    return result;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,103 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/styles/format.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Describes a format as an existing one with some of its components replaced.
+/// It only points to the base format and the replacements, so a stylesheet can
+/// hash it and compare it with the formats it has without building a new format.
+/// The base format and replacements must outlive the builder.
+/// </summary>
+class format_builder
+{
+public:
+    explicit format_builder(const format &base);
+
+    // These work like the format setters of the same name.
+
+    format_builder &set_alignment(const alignment &new_alignment);
+    format_builder &set_border(const border &new_border);
+    format_builder &set_fill(const fill &new_fill);
+    format_builder &set_font(const font &new_font);
+    format_builder &set_number_format(const number_format &new_number_format);
+    format_builder &set_protection(const protection &new_protection);
+
+    /// <summary>
+    /// Return the same value as build().hash().
+    /// </summary>
+    std::size_t hash() const;
+
+    /// <summary>
+    /// Return true if build() would return a format equal to other.
+    /// </summary>
+    bool operator==(const format &other) const;
+
+    /// <summary>
+    /// Return a copy of the base format with the replacements applied.
+    /// </summary>
+    format build() const;
+
+private:
+    bool alignment_applied() const;
+    bool border_applied() const;
+    bool fill_applied() const;
+    bool font_applied() const;
+    bool number_format_applied() const;
+    bool protection_applied() const;
+
+    const alignment &get_alignment() const;
+    const border &get_border() const;
+    const fill &get_fill() const;
+    const font &get_font() const;
+    const number_format &get_number_format() const;
+    const protection &get_protection() const;
+
+    const format &base_;
+
+    // nullptr where the base format's component is kept
+    const alignment *alignment_;
+    const border *border_;
+    const fill *fill_;
+    const font *font_;
+    const number_format *number_format_;
+    const protection *protection_;
+};
+
+/// <summary>
+/// Allows formats to be looked up by builders in a stylesheet's format index.
+/// </summary>
+inline bool operator==(const format &left, const format_builder &right)
+{
+    return right == left;
+}
+
+} // namespace detail
+} // namespace xlnt
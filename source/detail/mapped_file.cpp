@@ -0,0 +1,218 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#ifdef _WIN32
+#include <detail/include_windows.hpp>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <detail/mapped_file.hpp>
+
+namespace xlnt {
+namespace detail {
+
+mapped_file::mapped_file()
+{
+}
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool mapped_file::open(const std::string &filename)
+{
+    close();
+
+    auto file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0
+        || static_cast<unsigned long long>(file_size.QuadPart) > static_cast<std::size_t>(-1))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<const char *>(view);
+    size_ = static_cast<std::size_t>(file_size.QuadPart);
+
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (data_ != nullptr)
+    {
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+    }
+
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = nullptr;
+    file_ = nullptr;
+}
+
+bool mapped_file::is_same_file(const std::string &filename) const
+{
+    if (data_ == nullptr)
+    {
+        return false;
+    }
+
+    auto file = CreateFileA(filename.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    BY_HANDLE_FILE_INFORMATION mapped_info;
+    BY_HANDLE_FILE_INFORMATION other_info;
+
+    auto same = GetFileInformationByHandle(file_, &mapped_info) && GetFileInformationByHandle(file, &other_info)
+        && mapped_info.dwVolumeSerialNumber == other_info.dwVolumeSerialNumber
+        && mapped_info.nFileIndexHigh == other_info.nFileIndexHigh
+        && mapped_info.nFileIndexLow == other_info.nFileIndexLow;
+
+    CloseHandle(file);
+
+    return same;
+}
+
+#else
+
+bool mapped_file::open(const std::string &filename)
+{
+    close();
+
+    auto file = ::open(filename.c_str(), O_RDONLY);
+
+    if (file == -1)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(file, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    auto size = static_cast<std::size_t>(file_stat.st_size);
+    auto view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // the mapping stays valid once the descriptor is closed
+    ::close(file);
+
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    data_ = static_cast<const char *>(view);
+    size_ = size;
+    device_ = static_cast<unsigned long long>(file_stat.st_dev);
+    inode_ = static_cast<unsigned long long>(file_stat.st_ino);
+
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (data_ != nullptr)
+    {
+        munmap(const_cast<char *>(data_), size_);
+    }
+
+    data_ = nullptr;
+    size_ = 0;
+    device_ = 0;
+    inode_ = 0;
+}
+
+bool mapped_file::is_same_file(const std::string &filename) const
+{
+    struct stat file_stat;
+
+    return data_ != nullptr && stat(filename.c_str(), &file_stat) == 0
+        && static_cast<unsigned long long>(file_stat.st_dev) == device_
+        && static_cast<unsigned long long>(file_stat.st_ino) == inode_;
+}
+
+#endif
+
+bool mapped_file::is_open() const
+{
+    return data_ != nullptr;
+}
+
+const char *mapped_file::data() const
+{
+    return data_;
+}
+
+std::size_t mapped_file::size() const
+{
+    return size_;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,81 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A read-only view of a whole file mapped into memory. Pages are read from
+/// disk by the OS as they are touched rather than all at once.
+/// </summary>
+class mapped_file
+{
+public:
+    mapped_file();
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /// <summary>
+    /// Map the file called filename, closing any file already mapped. Returns false
+    /// if the file couldn't be opened or mapped, including when it's empty.
+    /// </summary>
+    bool open(const std::string &filename);
+
+    /// <summary>
+    /// Unmap the file. data must not be used afterwards.
+    /// </summary>
+    void close();
+
+    bool is_open() const;
+
+    /// <summary>
+    /// Return true if the mapped file is the file called filename. Files are
+    /// compared by identity, so a different path to the same file also matches.
+    /// </summary>
+    bool is_same_file(const std::string &filename) const;
+
+    const char *data() const;
+    std::size_t size() const;
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#else
+    unsigned long long device_ = 0;
+    unsigned long long inode_ = 0;
+#endif
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -1117,13 +1117,13 @@ bool write_base_format(const xlnt::base_format &xf, const xlnt::detail::styleshe
 {
     xf_node.append_attribute("numFmtId").set_value(std::to_string(xf.get_number_format().get_id()).c_str());
      
-    auto font_id = std::distance(stylesheet.fonts.begin(), std::find(stylesheet.fonts.begin(), stylesheet.fonts.end(), xf.get_font()));
+    auto font_id = stylesheet.index(xf.get_font());
     xf_node.append_attribute("fontId").set_value(std::to_string(font_id).c_str());
 
-    auto fill_id = std::distance(stylesheet.fills.begin(), std::find(stylesheet.fills.begin(), stylesheet.fills.end(), xf.get_fill()));
+    auto fill_id = stylesheet.index(xf.get_fill());
     xf_node.append_attribute("fillId").set_value(std::to_string(fill_id).c_str());
 
-    auto border_id = std::distance(stylesheet.borders.begin(), std::find(stylesheet.borders.begin(), stylesheet.borders.end(), xf.get_border()));
+    auto border_id = stylesheet.index(xf.get_border());
     xf_node.append_attribute("borderId").set_value(std::to_string(border_id).c_str());
 
     if(xf.number_format_applied()) xf_node.append_attribute("applyNumberFormat").set_value("1");
@@ -1259,6 +1259,9 @@ bool style_serializer::read_stylesheet(const pugi::xml_document &xml)
     read_styles(stylesheet_node.child("cellStyles"), stylesheet_node.child("cellStyleXfs"), stylesheet_, stylesheet_.styles, stylesheet_.style_name_map);
     read_formats(stylesheet_node.child("cellXfs"), stylesheet_, stylesheet_.formats, stylesheet_.format_styles);
 
+    // the vectors were cleared and filled again behind the stylesheet's back
+    stylesheet_.clear_indices();
+
     return true;
 }
 
@@ -23,6 +23,8 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <algorithm>
+#include <functional> // for std::hash
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,31 +36,144 @@
 #include <xlnt/styles/number_format.hpp>
 #include <xlnt/styles/style.hpp>
 
-namespace {
+#include <detail/format_builder.hpp>
 
-template<typename T>
-std::size_t search_vector(const std::vector<T> &items, const T &to_find)
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Hashes an item of a stylesheet by its identity. Anything else with a hash()
+/// matching T's, like a format_builder, can be hashed the same way.
+/// </summary>
+template <typename T>
+struct item_hash
 {
-    auto match = std::find(items.begin(), items.end(), to_find);
-    
-    if (match == items.end())
+    template <typename Key>
+    std::size_t operator()(const Key &item) const
     {
-        throw std::out_of_range("xlnt::stylesheet index lookup");
+        return item.hash();
     }
-    
-    return std::distance(items.begin(), match);
-}
+};
 
-} // namespace
+/// <summary>
+/// Compares items of a stylesheet by their identity.
+/// </summary>
+template <typename T>
+struct item_equal
+{
+    template <typename Key>
+    bool operator()(const T &left, const Key &right) const
+    {
+        return left == right;
+    }
+};
 
-namespace xlnt {
-namespace detail {
+/// <summary>
+/// Number formats are matched by their format string alone when deciding
+/// whether a custom one has to be added for a new format.
+/// </summary>
+struct number_format_string_hash
+{
+    std::size_t operator()(const number_format &item) const
+    {
+        return std::hash<std::string>()(item.get_format_string());
+    }
+};
+
+struct number_format_string_equal
+{
+    bool operator()(const number_format &left, const number_format &right) const
+    {
+        return left.get_format_string() == right.get_format_string();
+    }
+};
+
+/// <summary>
+/// Finds items in one of the vectors of a stylesheet by hash rather than by
+/// searching the vector. The vector is still filled directly when a stylesheet
+/// is read so anything appended to it since the last lookup is indexed then.
+/// </summary>
+template <typename T, typename Hash = item_hash<T>, typename Equal = item_equal<T>>
+class item_index
+{
+public:
+    /// <summary>
+    /// Return the index of the first item in items which is equal to item, or
+    /// items.size() if there isn't one. item doesn't have to be a T as long as
+    /// Hash and Equal accept it.
+    /// </summary>
+    template <typename Key>
+    std::size_t find(const std::vector<T> &items, const Key &item) const
+    {
+        // the vector was cleared and has fewer items than were indexed
+        if (items.size() < indexed_)
+        {
+            first_indices_.clear();
+            indexed_ = 0;
+        }
+
+        for (; indexed_ < items.size(); ++indexed_)
+        {
+            first_indices_.emplace(Hash()(items[indexed_]), indexed_);
+        }
+
+        auto match = first_indices_.find(Hash()(item));
+
+        if (match == first_indices_.end())
+        {
+            return items.size();
+        }
+
+        if (Equal()(items[match->second], item))
+        {
+            return match->second;
+        }
+
+        // a different item with the same hash or one which was changed in place
+        auto equal = std::find_if(items.begin(), items.end(), [&item](const T &other) { return Equal()(other, item); });
+        return static_cast<std::size_t>(std::distance(items.begin(), equal));
+    }
+
+    /// <summary>
+    /// Return the index of the first item in items which is equal to item,
+    /// appending it first if there isn't one.
+    /// </summary>
+    std::size_t add(std::vector<T> &items, const T &item)
+    {
+        auto index = find(items, item);
+
+        if (index == items.size())
+        {
+            items.push_back(item);
+        }
+
+        return index;
+    }
+
+    /// <summary>
+    /// Forget everything indexed so far. This has to be done when the vector is
+    /// replaced or cleared and refilled.
+    /// </summary>
+    void clear()
+    {
+        first_indices_.clear();
+        indexed_ = 0;
+    }
+
+private:
+    mutable std::unordered_map<std::size_t, std::size_t> first_indices_;
+    mutable std::size_t indexed_ = 0;
+};
 
 struct stylesheet
 {
     ~stylesheet() {}
     
-    std::size_t index(const format &f) { return search_vector(formats, f); }
+    /// <summary>
+    /// Return the index of the first format equal to f, or formats.size() if
+    /// there isn't one. The other overloads work the same way.
+    /// </summary>
+    std::size_t index(const format &f) const { return format_index.find(formats, f); }
     
     std::size_t index(const std::string &style_name)
     {
@@ -73,72 +188,128 @@ struct stylesheet
         return std::distance(styles.begin(), match);
     }
 
-    std::size_t index(const border &b) { return search_vector(borders, b); }
-    std::size_t index(const fill &f) { return search_vector(fills, f); }
-    std::size_t index(const font &f) { return search_vector(fonts, f); }
-    std::size_t index(const number_format &f) { return search_vector(number_formats, f); }
+    std::size_t index(const border &b) const { return border_index.find(borders, b); }
+    std::size_t index(const fill &f) const { return fill_index.find(fills, f); }
+    std::size_t index(const font &f) const { return font_index.find(fonts, f); }
+    std::size_t index(const number_format &f) const { return number_format_index.find(number_formats, f); }
     
+    /// <summary>
+    /// Return the index of the format f describes, adding it first if there isn't
+    /// one. The format is only built if it has to be added.
+    /// </summary>
+    std::size_t add_format(const format_builder &f)
+    {
+        auto match = format_index.find(formats, f);
+
+        if (match != formats.size())
+        {
+            return match;
+        }
+
+        return add_format(f.build());
+    }
+
     std::size_t add_format(const format &f)
     {
-        auto match = std::find(formats.begin(), formats.end(), f);
-        
-        if (match != formats.end())
+        auto match = index(f);
+
+        if (match != formats.size())
         {
-            return std::distance(formats.begin(), match);
+            return match;
         }
-        
-        auto number_format_match = std::find_if(number_formats.begin(), number_formats.end(), [&](const number_format &nf) { return nf.get_format_string() == f.get_number_format().get_format_string(); });
-        
-        if (number_format_match == number_formats.end() && f.get_number_format().get_id() >= 164)
+
+        const auto &nf = f.get_number_format();
+
+        if (nf.get_id() >= 164)
         {
-            number_formats.push_back(f.get_number_format());
+            number_format_string_index.add(number_formats, nf);
         }
-        
+
         formats.push_back(f);
         format_styles.push_back("Normal");
-        
-        try
-        {
-            search_vector(borders, f.get_border());
-        }
-        catch(std::out_of_range)
-        {
-            borders.push_back(f.get_border());
-        }
 
-        try
-        {
-            search_vector(fills, f.get_fill());
-        }
-        catch(std::out_of_range)
-        {
-            fills.push_back(f.get_fill());
-        }
-        
-        try
+        border_index.add(borders, f.get_border());
+        fill_index.add(fills, f.get_fill());
+        font_index.add(fonts, f.get_font());
+
+        if (nf.get_id() >= 164)
         {
-            search_vector(fonts, f.get_font());
+            number_format_index.add(number_formats, nf);
         }
-        catch(std::out_of_range)
+
+        return formats.size() - 1;
+    }
+
+    /// <summary>
+    /// Forget what's been indexed so far. Called after the vectors have been
+    /// cleared and filled again, like when a stylesheet is read.
+    /// </summary>
+    void clear_indices()
+    {
+        format_index.clear();
+        border_index.clear();
+        fill_index.clear();
+        font_index.clear();
+        number_format_index.clear();
+        number_format_string_index.clear();
+    }
+    
+    /// <summary>
+    /// Replace formats with the formats at the given indices, in that order, and
+    /// drop the borders, fills, fonts and number formats no remaining format or
+    /// style uses. Excel expects the first two fills to be there whether they're
+    /// used or not, so they're always kept.
+    /// </summary>
+    void compact(const std::vector<std::size_t> &kept_formats)
+    {
+        std::vector<format> new_formats;
+        std::vector<std::string> new_format_styles;
+
+        for (auto index : kept_formats)
         {
-            fonts.push_back(f.get_font());
+            new_formats.push_back(formats.at(index));
+            new_format_styles.push_back(format_styles.at(index));
         }
-        
-        if (f.get_number_format().get_id() >= 164)
+
+        std::vector<bool> used_borders(borders.size(), false);
+        std::vector<bool> used_fills(fills.size(), false);
+        std::vector<bool> used_fonts(fonts.size(), false);
+        std::vector<bool> used_number_formats(number_formats.size(), false);
+
+        auto mark = [](std::vector<bool> &used, std::size_t index)
         {
-            try
+            if (index < used.size())
             {
-                search_vector(number_formats, f.get_number_format());
-            }
-            catch(std::out_of_range)
-            {
-                number_formats.push_back(f.get_number_format());
+                used[index] = true;
             }
+        };
+
+        auto mark_components = [&](const base_format &f)
+        {
+            mark(used_borders, index(f.get_border()));
+            mark(used_fills, index(f.get_fill()));
+            mark(used_fonts, index(f.get_font()));
+            mark(used_number_formats, index(f.get_number_format()));
+        };
+
+        std::for_each(new_formats.begin(), new_formats.end(), mark_components);
+        std::for_each(styles.begin(), styles.end(), mark_components);
+
+        for (std::size_t i = 0; i < 2 && i < used_fills.size(); i++)
+        {
+            used_fills[i] = true;
         }
-        
-        return formats.size() - 1;
+
+        formats = std::move(new_formats);
+        format_styles = std::move(new_format_styles);
+        erase_unused(borders, used_borders);
+        erase_unused(fills, used_fills);
+        erase_unused(fonts, used_fonts);
+        erase_unused(number_formats, used_number_formats);
+
+        clear_indices();
     }
-    
+
     std::size_t add_style(const style &s)
     {
         auto match = std::find(styles.begin(), styles.end(), s);
@@ -152,6 +323,22 @@ struct stylesheet
         return styles.size() - 1;
     }
 
+    template <typename T>
+    static void erase_unused(std::vector<T> &items, const std::vector<bool> &used)
+    {
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < items.size(); i++)
+        {
+            if (used[i])
+            {
+                items[kept++] = items[i];
+            }
+        }
+
+        items.erase(items.begin() + static_cast<std::ptrdiff_t>(kept), items.end());
+    }
+
     std::vector<format> formats;
     std::vector<std::string> format_styles;
     std::vector<style> styles;
@@ -166,6 +353,14 @@ struct stylesheet
     std::unordered_map<std::size_t, std::string> style_name_map;
     
     std::size_t next_custom_format_id = 164;
+
+    // lookups into the vectors above, updated as items are appended to them
+    item_index<format> format_index;
+    item_index<border> border_index;
+    item_index<fill> fill_index;
+    item_index<font> font_index;
+    item_index<number_format> number_format_index;
+    item_index<number_format, number_format_string_hash, number_format_string_equal> number_format_string_index;
 };
 
 } // namespace detail
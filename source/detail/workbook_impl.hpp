@@ -23,6 +23,8 @@
 #pragma once
 
 #include <iterator>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <detail/stylesheet.hpp>
@@ -30,6 +32,7 @@
 #include <xlnt/packaging/app_properties.hpp>
 #include <xlnt/packaging/document_properties.hpp>
 #include <xlnt/packaging/manifest.hpp>
+#include <xlnt/packaging/zip_file.hpp>
 #include <xlnt/workbook/theme.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
@@ -50,13 +53,22 @@ struct workbook_impl
           relationships_(other.relationships_),
           root_relationships_(other.root_relationships_),
           shared_strings_(other.shared_strings_),
+          shared_string_index_(other.shared_string_index_),
           properties_(other.properties_),
           app_properties_(other.app_properties_),
           guess_types_(other.guess_types_),
           data_only_(other.data_only_),
           read_only_(other.read_only_),
+          optimized_write_(other.optimized_write_),
+          parallel_load_(other.parallel_load_),
+          parallel_save_(other.parallel_save_),
+          copy_unmodified_sheets_(other.copy_unmodified_sheets_),
+          compact_styles_(other.compact_styles_),
+          compression_level_(other.compression_level_),
+          part_compression_levels_(other.part_compression_levels_),
           stylesheet_(other.stylesheet_),
-          manifest_(other.manifest_)
+          manifest_(other.manifest_),
+          archive_(other.archive_)
     {
     }
 
@@ -72,12 +84,21 @@ struct workbook_impl
                   std::back_inserter(root_relationships_));
         shared_strings_.clear();
         std::copy(other.shared_strings_.begin(), other.shared_strings_.end(), std::back_inserter(shared_strings_));
+        shared_string_index_ = other.shared_string_index_;
         properties_ = other.properties_;
         app_properties_ = other.app_properties_;
         guess_types_ = other.guess_types_;
         data_only_ = other.data_only_;
         read_only_ = other.read_only_;
+        optimized_write_ = other.optimized_write_;
+        parallel_load_ = other.parallel_load_;
+        parallel_save_ = other.parallel_save_;
+        copy_unmodified_sheets_ = other.copy_unmodified_sheets_;
+        compact_styles_ = other.compact_styles_;
+        compression_level_ = other.compression_level_;
+        part_compression_levels_ = other.part_compression_levels_;
         manifest_ = other.manifest_;
+        archive_ = other.archive_;
 
         return *this;
     }
@@ -88,18 +109,35 @@ struct workbook_impl
     std::vector<relationship> root_relationships_;
     std::vector<text> shared_strings_;
 
+    // Maps the hash of each shared string's plain text to its index in
+    // shared_strings_ so that add_shared_string doesn't have to scan the table.
+    std::unordered_multimap<std::size_t, std::size_t> shared_string_index_;
+
     document_properties properties_;
     app_properties app_properties_;
 
     bool guess_types_;
     bool data_only_;
     bool read_only_;
+    bool optimized_write_;
+    bool parallel_load_;
+    bool parallel_save_;
+    bool copy_unmodified_sheets_;
+    bool compact_styles_;
+
+    compression_level compression_level_;
+    std::unordered_map<std::string, compression_level> part_compression_levels_;
 
     stylesheet stylesheet_;
     
     manifest manifest_;
     theme theme_;
     std::vector<std::uint8_t> thumbnail_;
+
+    // Source archive of a read-only workbook, kept open so that its worksheets
+    // can be streamed after loading, or of one which copies unmodified sheets
+    // from it when it's saved.
+    std::shared_ptr<zip_file> archive_;
 };
 
 } // namespace detail
@@ -234,7 +234,7 @@ void workbook_serializer::write_workbook(pugi::xml_document &xml) const
 {
     std::size_t num_visible = 0;
 
-    for (auto ws : workbook_)
+    for (const auto ws : workbook_)
     {
         if (ws.get_page_setup().get_sheet_state() == sheet_state::visible)
         {
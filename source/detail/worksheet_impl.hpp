@@ -22,6 +22,7 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,6 +35,9 @@
 #include <xlnt/worksheet/row_properties.hpp>
 
 #include <detail/cell_impl.hpp>
+#include <detail/cell_store.hpp>
+#include <detail/worksheet_row_reader.hpp>
+#include <detail/worksheet_row_writer.hpp>
 
 namespace xlnt {
 
@@ -61,12 +65,12 @@ struct worksheet_impl
         column_properties_ = other.column_properties_;
         row_properties_ = other.row_properties_;
         title_ = other.title_;
-        cell_map_ = other.cell_map_;
-        for (auto &row : cell_map_)
+        cells_ = other.cells_;
+        for (auto &row : cells_)
         {
-            for (auto &cell : row.second)
+            for (auto cell : row.cells)
             {
-                cell.second.parent_ = this;
+                cell->parent_ = this;
             }
         }
         relationships_ = other.relationships_;
@@ -81,13 +85,19 @@ struct worksheet_impl
         print_title_rows_ = other.print_title_rows_;
         print_area_ = other.print_area_;
         view_ = other.view_;
+        source_part_ = other.source_part_;
+        unmodified_part_ = other.unmodified_part_;
+        row_reader_.reset();
+        // Only reached for sheets with a writer when the workbook's sheets are
+        // moved around; copying one is rejected by workbook.
+        row_writer_ = other.row_writer_;
     }
 
     workbook *parent_;
     std::unordered_map<column_t, column_properties> column_properties_;
     std::unordered_map<row_t, row_properties> row_properties_;
     std::string title_;
-    std::unordered_map<row_t, std::unordered_map<column_t, cell_impl>> cell_map_;
+    cell_store cells_;
     std::vector<relationship> relationships_;
     page_setup page_setup_;
     range_reference auto_filter_;
@@ -100,6 +110,20 @@ struct worksheet_impl
     std::string print_title_rows_;
     range_reference print_area_;
     sheet_view view_;
+
+    // Set for sheets of read-only workbooks whose cells are streamed from the
+    // source archive on demand instead of being loaded into cells_.
+    std::string source_part_;
+    std::unique_ptr<worksheet_row_reader> row_reader_;
+
+    // Set to the part a sheet was loaded from when the workbook keeps its source
+    // archive, and cleared by anything that could modify the sheet. Sheets which
+    // still have it set are copied from the source archive when they're saved.
+    std::string unmodified_part_;
+
+    // Set once rows of a sheet in an optimized write workbook have been appended.
+    // It is shared so that the stream survives the copies made as sheets are added.
+    std::shared_ptr<worksheet_row_writer> row_writer_;
 };
 
 } // namespace detail
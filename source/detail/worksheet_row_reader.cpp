@@ -0,0 +1,266 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <detail/worksheet_row_reader.hpp>
+#include <detail/worksheet_sax_handler.hpp>
+#include <detail/xml_sax_parser.hpp>
+#include <xlnt/packaging/zip_file.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Stores the cells of each row in the reader's queue instead of the worksheet.
+/// </summary>
+class worksheet_row_reader::row_handler : public worksheet_sax_handler
+{
+public:
+    row_handler(worksheet_row_reader &reader, worksheet sheet, stylesheet &stylesheet)
+        : worksheet_sax_handler(sheet, stylesheet),
+          reader_(reader)
+    {
+        cells_only_ = true;
+    }
+
+    bool has_started_sheet_data() const
+    {
+        return sheet_data_started_;
+    }
+
+    const std::string &get_dimension() const
+    {
+        return dimension_;
+    }
+
+protected:
+    cell target_cell(const cell_reference &reference) override
+    {
+        auto &rows = reader_.rows_;
+        auto row = reference.get_row();
+
+        if (rows.empty() || rows.back().index != row)
+        {
+            rows.emplace_back();
+            rows.back().index = row;
+        }
+
+        auto column = reference.get_column_index();
+        auto &cells = rows.back().cells;
+        auto match = cells.find(column);
+
+        if (match == cells.end())
+        {
+            match = cells.emplace(column, cell_impl(reader_.impl_, column, row)).first;
+        }
+
+        return match->second.self();
+    }
+
+    void end_row(row_t row) override
+    {
+        reader_.complete_row_ = row;
+    }
+
+private:
+    worksheet_row_reader &reader_;
+};
+
+worksheet_row_reader::worksheet_row_reader(worksheet sheet, worksheet_impl *impl, zip_file &archive,
+    const std::string &part, stylesheet &stylesheet)
+    : sheet_(sheet),
+      impl_(impl),
+      archive_(archive),
+      part_(part),
+      stylesheet_(stylesheet),
+      window_(16384)
+{
+}
+
+worksheet_row_reader::~worksheet_row_reader()
+{
+}
+
+cell_impl *worksheet_row_reader::get_cell(const cell_reference &reference)
+{
+    auto row = seek(reference.get_row());
+    auto column = reference.get_column_index();
+    auto match = row->cells.find(column);
+
+    if (match == row->cells.end())
+    {
+        match = row->cells.emplace(column, cell_impl(impl_, column, reference.get_row())).first;
+    }
+
+    return &match->second;
+}
+
+bool worksheet_row_reader::has_cell(const cell_reference &reference)
+{
+    auto row = seek(reference.get_row());
+
+    return row->cells.find(reference.get_column_index()) != row->cells.end();
+}
+
+range_reference worksheet_row_reader::get_dimension()
+{
+    if (has_dimension_)
+    {
+        return dimension_;
+    }
+
+    if (parser_ == nullptr)
+    {
+        restart();
+    }
+
+    while (!handler_->has_started_sheet_data() && read_window())
+    {
+    }
+
+    if (!handler_->get_dimension().empty())
+    {
+        dimension_ = range_reference(handler_->get_dimension());
+        has_dimension_ = true;
+
+        return dimension_;
+    }
+
+    // dimension is optional so without it every cell has to be visited once
+    restart();
+
+    bool empty = true;
+    row_t min_row = 0, max_row = 0;
+    column_t min_column = 0, max_column = 0;
+
+    auto update_extents = [&]()
+    {
+        for (const auto &row : rows_)
+        {
+            for (const auto &cell : row.cells)
+            {
+                min_row = empty ? row.index : std::min(min_row, row.index);
+                max_row = empty ? row.index : std::max(max_row, row.index);
+                min_column = empty ? cell.first : std::min(min_column, cell.first);
+                max_column = empty ? cell.first : std::max(max_column, cell.first);
+                empty = false;
+            }
+        }
+
+        rows_.clear();
+    };
+
+    while (read_window())
+    {
+        update_extents();
+    }
+
+    update_extents();
+
+    dimension_ = empty ? range_reference("A1:A1") : range_reference(min_column, min_row, max_column, max_row);
+    has_dimension_ = true;
+
+    // the next access starts again from the top of the part
+    parser_.reset();
+
+    return dimension_;
+}
+
+void worksheet_row_reader::restart()
+{
+    parser_.reset();
+    handler_.reset(new row_handler(*this, sheet_, stylesheet_));
+    parser_.reset(new xml_sax_parser(*handler_));
+    stream_ = archive_.read_stream(part_);
+    finished_ = false;
+
+    rows_.clear();
+    missing_row_ = row_buffer();
+    complete_row_ = 0;
+    discarded_row_ = 0;
+}
+
+bool worksheet_row_reader::read_window()
+{
+    if (finished_)
+    {
+        return false;
+    }
+
+    stream_->read(window_.data(), static_cast<std::streamsize>(window_.size()));
+    auto count = static_cast<std::size_t>(stream_->gcount());
+
+    if (stream_->bad())
+    {
+        throw std::runtime_error("couldn't read " + part_);
+    }
+
+    parser_->feed(window_.data(), count);
+
+    if (count < window_.size())
+    {
+        parser_->finish();
+        stream_.reset();
+        finished_ = true;
+    }
+
+    return !finished_;
+}
+
+worksheet_row_reader::row_buffer *worksheet_row_reader::seek(row_t row)
+{
+    if (parser_ == nullptr || row <= discarded_row_)
+    {
+        restart();
+    }
+
+    while (complete_row_ < row && read_window())
+    {
+    }
+
+    while (!rows_.empty() && rows_.front().index < row)
+    {
+        discarded_row_ = rows_.front().index;
+        rows_.pop_front();
+    }
+
+    if (!rows_.empty() && rows_.front().index == row)
+    {
+        return &rows_.front();
+    }
+
+    // rows missing from the XML get a scratch buffer of empty cells
+    if (missing_row_.index != row)
+    {
+        missing_row_.cells.clear();
+        missing_row_.index = row;
+    }
+
+    return &missing_row_;
+}
+
+} // namespace detail
+} // namespace xlnt
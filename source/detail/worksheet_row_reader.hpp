@@ -0,0 +1,116 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <deque>
+#include <istream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/cell_impl.hpp>
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+namespace xlnt {
+
+class zip_file;
+
+namespace detail {
+
+struct stylesheet;
+struct worksheet_impl;
+class xml_sax_parser;
+
+/// <summary>
+/// Streams the cells of a worksheet part for read-only workbooks. Rows are parsed
+/// on demand as cells are requested in increasing row order and a row's cells are
+/// discarded once a later row is requested, so memory use doesn't grow with the
+/// size of the sheet. Requesting a row that has already been discarded restarts
+/// the stream from the beginning of the part.
+/// </summary>
+class XLNT_CLASS worksheet_row_reader
+{
+public:
+    worksheet_row_reader(worksheet sheet, worksheet_impl *impl, zip_file &archive,
+        const std::string &part, stylesheet &stylesheet);
+    ~worksheet_row_reader();
+
+    /// <summary>
+    /// Return the cell at reference, reading up to its row if necessary. Cells that
+    /// aren't in the XML are created empty. The cell is only valid until a cell
+    /// in another row is requested.
+    /// </summary>
+    cell_impl *get_cell(const cell_reference &reference);
+
+    /// <summary>
+    /// Return true if the XML has a cell at reference.
+    /// </summary>
+    bool has_cell(const cell_reference &reference);
+
+    /// <summary>
+    /// Return the dimension element of the worksheet. If there isn't one, the
+    /// whole part is scanned once to find the extents of its cells.
+    /// </summary>
+    range_reference get_dimension();
+
+private:
+    class row_handler;
+
+    struct row_buffer
+    {
+        row_t index = 0;
+        std::unordered_map<column_t, cell_impl> cells;
+    };
+
+    void restart();
+    bool read_window();
+    row_buffer *seek(row_t row);
+
+    worksheet sheet_;
+    worksheet_impl *impl_;
+    zip_file &archive_;
+    std::string part_;
+    stylesheet &stylesheet_;
+
+    std::unique_ptr<std::istream> stream_;
+    std::unique_ptr<row_handler> handler_;
+    std::unique_ptr<xml_sax_parser> parser_;
+    std::vector<char> window_;
+    bool finished_ = true;
+
+    std::deque<row_buffer> rows_;
+    row_buffer missing_row_;
+    row_t complete_row_ = 0;
+    row_t discarded_row_ = 0;
+
+    bool has_dimension_ = false;
+    range_reference dimension_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,136 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#include <pugixml.hpp>
+#include <sstream>
+#include <stdexcept>
+
+#include <detail/worksheet_impl.hpp>
+#include <detail/worksheet_row_writer.hpp>
+#include <detail/worksheet_serializer.hpp>
+
+namespace xlnt {
+namespace detail {
+
+worksheet_row_writer::worksheet_row_writer(compression_level level) : stream_(level)
+{
+}
+
+worksheet_row_writer::~worksheet_row_writer()
+{
+}
+
+void worksheet_row_writer::write_rows(worksheet sheet)
+{
+    if (stream_.is_finished())
+    {
+        throw std::runtime_error("can't append rows to a worksheet which has been saved in optimized write mode");
+    }
+
+    auto &cells = sheet.d_->cells_;
+
+    if (cells.empty())
+    {
+        return;
+    }
+
+    auto lowest_row = cells.begin()->index;
+    auto highest_row = (cells.end() - 1)->index;
+
+    if (lowest_row <= last_row_)
+    {
+        throw std::runtime_error("rows must be written in order in optimized write mode");
+    }
+
+    if (!started_)
+    {
+        std::string after_sheet_data;
+        stream_ << write_skeleton(sheet, after_sheet_data);
+        started_ = true;
+    }
+
+    pugi::xml_document rows_xml;
+    auto sheet_data_node = rows_xml.append_child("sheetData");
+    worksheet_serializer(sheet).write_rows(sheet_data_node, hyperlink_references_);
+
+    for (auto row_node : sheet_data_node.children())
+    {
+        row_node.print(stream_, "", pugi::format_raw);
+    }
+
+    last_row_ = highest_row;
+    cells.clear();
+}
+
+row_t worksheet_row_writer::get_next_row() const
+{
+    return last_row_ + 1;
+}
+
+void worksheet_row_writer::save(worksheet sheet, zip_file &archive, const std::string &part)
+{
+    if (!stream_.is_finished())
+    {
+        write_rows(sheet);
+
+        std::string after_sheet_data;
+        auto before_sheet_data = write_skeleton(sheet, after_sheet_data);
+
+        if (!started_)
+        {
+            stream_ << before_sheet_data;
+            started_ = true;
+        }
+
+        stream_ << after_sheet_data;
+        stream_.finish();
+    }
+
+    archive.writestr(part, stream_);
+}
+
+std::string worksheet_row_writer::write_skeleton(worksheet sheet, std::string &after_sheet_data) const
+{
+    pugi::xml_document xml;
+    worksheet_serializer(sheet).write_worksheet_skeleton(xml, hyperlink_references_);
+
+    std::ostringstream ss;
+    xml.save(ss);
+    auto skeleton = ss.str();
+
+    // The empty sheetData element is split open so rows can be written between the halves.
+    auto sheet_data_start = skeleton.find("<sheetData");
+    auto sheet_data_end = skeleton.find("/>", sheet_data_start);
+
+    if (sheet_data_start == std::string::npos || sheet_data_end == std::string::npos)
+    {
+        throw std::runtime_error("worksheet is missing sheetData");
+    }
+
+    after_sheet_data = "</sheetData>" + skeleton.substr(sheet_data_end + 2);
+
+    return skeleton.substr(0, sheet_data_start) + "<sheetData>";
+}
+
+} // namespace detail
+} // namespace xlnt
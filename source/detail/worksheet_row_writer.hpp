@@ -0,0 +1,77 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/packaging/zip_file.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Streams the rows of a worksheet in an optimized write workbook into a deflated
+/// worksheet part as they are appended. The part up to sheetData is written with
+/// the first rows and the rest of it when the workbook is saved.
+/// </summary>
+class XLNT_CLASS worksheet_row_writer
+{
+public:
+    /// <summary>
+    /// Construct a writer which compresses the part at level.
+    /// </summary>
+    worksheet_row_writer(compression_level level);
+    ~worksheet_row_writer();
+
+    /// <summary>
+    /// Serialize the rows of sheet which are held in memory and remove them from
+    /// the sheet. Throws if a row has already been written or the part is finished.
+    /// </summary>
+    void write_rows(worksheet sheet);
+
+    /// <summary>
+    /// Return the row following the last one written.
+    /// </summary>
+    row_t get_next_row() const;
+
+    /// <summary>
+    /// Finish the part if necessary and add it to archive.
+    /// </summary>
+    void save(worksheet sheet, zip_file &archive, const std::string &part);
+
+private:
+    std::string write_skeleton(worksheet sheet, std::string &after_sheet_data) const;
+
+    deflate_ostream stream_;
+    std::unordered_map<std::string, std::string> hyperlink_references_;
+    bool started_ = false;
+    row_t last_row_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,441 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <limits>
+#include <stdexcept>
+
+#include <detail/cell_impl.hpp>
+#include <detail/stylesheet.hpp>
+#include <detail/worksheet_sax_handler.hpp>
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/text.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/column_properties.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/row_properties.hpp>
+
+namespace {
+
+/// <summary>
+/// Parse a relative reference like "AB12" directly into a cell_reference without
+/// building intermediate strings. Absolute or lowercase references are rare in
+/// worksheet XML so they're left to the general parser.
+/// </summary>
+xlnt::cell_reference parse_cell_reference(const std::string &reference)
+{
+    std::size_t i = 0;
+    xlnt::column_t::index_t column = 0;
+
+    while (i < reference.size() && i < 3 && reference[i] >= 'A' && reference[i] <= 'Z')
+    {
+        column = column * 26 + static_cast<xlnt::column_t::index_t>(reference[i] - 'A' + 1);
+        i++;
+    }
+
+    auto row_begin = i;
+    xlnt::row_t row = 0;
+
+    while (i < reference.size() && i - row_begin < 7 && reference[i] >= '0' && reference[i] <= '9')
+    {
+        row = row * 10 + static_cast<xlnt::row_t>(reference[i] - '0');
+        i++;
+    }
+
+    if (row_begin == 0 || i == row_begin || i != reference.size())
+    {
+        return xlnt::cell_reference(reference);
+    }
+
+    return xlnt::cell_reference(column, row);
+}
+
+/// <summary>
+/// Return the value of an attribute the schema requires element to have,
+/// throwing invalid_file_error if it's missing.
+/// </summary>
+const std::string &required_attribute(const xlnt::detail::sax_attributes &attributes,
+    const char *name, const std::string &element)
+{
+    auto value = attributes.find(name);
+
+    if (value == nullptr)
+    {
+        throw xlnt::invalid_file_error("worksheet " + element + " element is missing " + name);
+    }
+
+    return *value;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+worksheet_sax_handler::worksheet_sax_handler(worksheet sheet, stylesheet &stylesheet)
+    : sheet_(sheet),
+      stylesheet_(stylesheet),
+      shared_strings_(sheet.get_workbook().get_shared_strings())
+{
+}
+
+void worksheet_sax_handler::start_element(const std::string &name, const sax_attributes &attributes)
+{
+    if (in_cell_)
+    {
+        start_cell_child(name, attributes);
+    }
+    else if (name == "c")
+    {
+        start_cell(attributes);
+    }
+    else if (name == "row")
+    {
+        auto r = attributes.find("r");
+        row_ = r != nullptr ? static_cast<row_t>(std::stoull(*r)) : row_ + 1;
+        cell_count_ = 0;
+
+        auto ht = attributes.find("ht");
+
+        if (ht != nullptr && !cells_only_)
+        {
+            sheet_.get_row_properties(row_).height = std::stold(*ht);
+        }
+    }
+    else if (name == "sheetData")
+    {
+        sheet_data_started_ = true;
+    }
+    else if (name == "dimension")
+    {
+        auto ref = attributes.find("ref");
+        dimension_ = ref != nullptr ? *ref : "";
+    }
+    else if (cells_only_)
+    {
+        return;
+    }
+    else if (name == "col")
+    {
+        read_column_properties(attributes);
+    }
+    else if (name == "mergeCells")
+    {
+        auto count = attributes.find("count");
+        has_merge_count_ = count != nullptr;
+        merge_count_ = has_merge_count_ ? std::stoll(*count) : 0;
+    }
+    else if (name == "mergeCell")
+    {
+        range_reference merged(required_attribute(attributes, "ref", name));
+
+        if (defer_workbook_changes_)
+        {
+            deferred_merges_.push_back(merged);
+        }
+        else
+        {
+            sheet_.merge_cells(merged);
+        }
+
+        merge_count_--;
+    }
+    else if (name == "autoFilter")
+    {
+        sheet_.auto_filter(range_reference(required_attribute(attributes, "ref", name)));
+    }
+}
+
+void worksheet_sax_handler::end_element(const std::string &name)
+{
+    if (in_cell_)
+    {
+        if (name == "c")
+        {
+            in_cell_ = false;
+        }
+        else if (name == "is")
+        {
+            in_inline_string_ = false;
+        }
+        else if (name == "rPh")
+        {
+            in_phonetic_run_ = false;
+        }
+
+        target_ = nullptr;
+    }
+    else if (name == "row")
+    {
+        flush_row();
+    }
+    else if (name == "mergeCells" && has_merge_count_ && merge_count_ != 0)
+    {
+        throw std::runtime_error("mismatch between count and actual number of merged cells");
+    }
+}
+
+void worksheet_sax_handler::characters(const std::string &text)
+{
+    if (target_ != nullptr)
+    {
+        target_->append(text);
+    }
+}
+
+cell worksheet_sax_handler::target_cell(const cell_reference &reference)
+{
+    return sheet_.get_cell(reference);
+}
+
+void worksheet_sax_handler::end_row(row_t /*row*/)
+{
+}
+
+void worksheet_sax_handler::start_cell(const sax_attributes &attributes)
+{
+    // slots are reused from row to row to keep their string buffers
+    if (cell_count_ == cells_.size())
+    {
+        cells_.emplace_back();
+    }
+
+    auto &cell = cells_[cell_count_++];
+
+    auto r = attributes.find("r");
+
+    if (r != nullptr)
+    {
+        cell.reference = parse_cell_reference(*r);
+    }
+    else
+    {
+        // r is optional, an omitted reference means the column after the previous cell
+        auto column = cell_count_ > 1 ? cells_[cell_count_ - 2].reference.get_column_index() + 1 : 1;
+        cell.reference = cell_reference(column, row_);
+    }
+
+    auto t = attributes.find("t");
+    cell.type = t != nullptr ? *t : "";
+
+    auto s = attributes.find("s");
+    cell.has_format = s != nullptr;
+    cell.format_id = static_cast<std::size_t>(cell.has_format ? std::stoull(*s) : 0LL);
+
+    cell.has_value = false;
+    cell.value.clear();
+    cell.has_formula = false;
+    cell.has_shared_formula = false;
+    cell.formula.clear();
+    cell.inline_string.clear();
+
+    in_cell_ = true;
+}
+
+void worksheet_sax_handler::start_cell_child(const std::string &name, const sax_attributes &attributes)
+{
+    auto &cell = cells_[cell_count_ - 1];
+
+    if (name == "v")
+    {
+        cell.has_value = true;
+        target_ = &cell.value;
+    }
+    else if (name == "f")
+    {
+        auto t = attributes.find("t");
+        cell.has_formula = true;
+        cell.has_shared_formula = t != nullptr && *t == "shared";
+        target_ = &cell.formula;
+    }
+    else if (name == "is")
+    {
+        in_inline_string_ = true;
+    }
+    else if (name == "rPh")
+    {
+        in_phonetic_run_ = true;
+    }
+    else if (name == "t" && in_inline_string_ && !in_phonetic_run_)
+    {
+        target_ = &cell.inline_string;
+    }
+}
+
+void worksheet_sax_handler::read_column_properties(const sax_attributes &attributes)
+{
+    auto min = static_cast<column_t::index_t>(std::stoull(required_attribute(attributes, "min", "col")));
+    auto max = static_cast<column_t::index_t>(std::stoull(required_attribute(attributes, "max", "col")));
+    auto width_attribute = attributes.find("width");
+    auto width = width_attribute != nullptr ? std::stold(*width_attribute) : column_properties().width;
+    auto custom_width = attributes.find("customWidth");
+    bool custom = custom_width != nullptr && *custom_width == "1";
+    auto style = attributes.find("style");
+    auto column_style = static_cast<std::size_t>(style != nullptr ? std::stoull(*style) : 0);
+
+    for (auto column = min; column <= max; column++)
+    {
+        if (!sheet_.has_column_properties(column))
+        {
+            sheet_.add_column_properties(column, column_properties());
+        }
+
+        auto &properties = sheet_.get_column_properties(column);
+        properties.width = width;
+        properties.style = column_style;
+        properties.custom = custom;
+    }
+}
+
+void worksheet_sax_handler::flush_row()
+{
+    for (std::size_t i = 0; i < cell_count_; i++)
+    {
+        const auto &data = cells_[i];
+        auto cell = target_cell(data.reference);
+
+        if (data.has_formula && !data.has_shared_formula && !sheet_.get_workbook().get_data_only())
+        {
+            cell.set_formula(data.formula);
+        }
+
+        if (defer_workbook_changes_ && (data.type == "inlineStr" || data.type == "str" || data.has_format))
+        {
+            deferred_cell deferred = { cell.d_, data.has_format, data.format_id, false, 0 };
+
+            if (data.has_format && data.format_id >= stylesheet_.formats.size())
+            {
+                throw std::out_of_range("format index out of range");
+            }
+
+            if (data.type == "inlineStr" || data.type == "str")
+            {
+                deferred.has_string = true;
+                deferred.string_index = deferred_strings_.size();
+                deferred_strings_.push_back(data.type == "str" ? data.value : data.inline_string);
+            }
+
+            deferred_cells_.push_back(deferred);
+        }
+
+        if (data.type == "inlineStr") // inline string
+        {
+            if (!defer_workbook_changes_)
+            {
+                cell.set_value(data.inline_string);
+            }
+        }
+        else if (data.type == "s" && !data.has_formula) // shared string
+        {
+            auto shared_string_index = static_cast<std::size_t>(std::stoull(data.value));
+
+            if (shared_string_index >= shared_strings_.size())
+            {
+                throw std::out_of_range("shared string index out of range");
+            }
+
+            // the string is already in the workbook's table so just point at it
+            cell.d_->type_ = cell::type::string;
+            cell.d_->value_string_ = shared_string_index;
+        }
+        else if (data.type == "b") // boolean
+        {
+            cell.set_value(data.value != "0");
+        }
+        else if (data.type == "str")
+        {
+            if (!defer_workbook_changes_)
+            {
+                cell.set_value(data.value);
+            }
+        }
+        else if (data.has_value && !data.value.empty())
+        {
+            if (data.value[0] == '#')
+            {
+                cell.set_error(data.value);
+            }
+            else
+            {
+                cell.set_value(std::stold(data.value));
+            }
+        }
+
+        if (data.has_format && !defer_workbook_changes_)
+        {
+            cell.set_format(stylesheet_.formats.at(data.format_id));
+        }
+    }
+
+    cell_count_ = 0;
+    end_row(row_);
+}
+
+void worksheet_sax_handler::defer_workbook_changes()
+{
+    defer_workbook_changes_ = true;
+}
+
+void worksheet_sax_handler::apply_workbook_changes(std::vector<std::size_t> &format_ids)
+{
+    const auto no_format = std::numeric_limits<std::size_t>::max();
+    format_ids.resize(stylesheet_.formats.size(), no_format);
+
+    for (const auto &deferred : deferred_cells_)
+    {
+        auto cell = deferred.cell->self();
+
+        if (deferred.has_string)
+        {
+            cell.set_value(deferred_strings_[deferred.string_index]);
+        }
+
+        if (deferred.has_format)
+        {
+            auto &format_id = format_ids[deferred.format_id];
+
+            // add_format returns the same id for a format every time once it's been added
+            if (format_id == no_format)
+            {
+                format_id = sheet_.get_workbook().add_format(stylesheet_.formats[deferred.format_id]);
+            }
+
+            deferred.cell->format_id_ = static_cast<std::uint32_t>(format_id);
+            deferred.cell->has_format_ = true;
+        }
+    }
+
+    for (const auto &merged : deferred_merges_)
+    {
+        sheet_.merge_cells(merged);
+    }
+
+    deferred_cells_.clear();
+    deferred_strings_.clear();
+    deferred_merges_.clear();
+    defer_workbook_changes_ = false;
+}
+
+} // namespace detail
+} // namespace xlnt
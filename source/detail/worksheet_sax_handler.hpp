@@ -0,0 +1,158 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <detail/xml_sax_parser.hpp>
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+namespace xlnt {
+
+class cell;
+class text;
+
+namespace detail {
+
+struct cell_impl;
+struct stylesheet;
+
+/// <summary>
+/// Builds a worksheet from the SAX events of its XML part. Cells are buffered
+/// one row at a time and stored when the row's end tag is reached.
+/// </summary>
+class XLNT_CLASS worksheet_sax_handler : public sax_handler
+{
+public:
+    worksheet_sax_handler(worksheet sheet, stylesheet &stylesheet);
+
+    void start_element(const std::string &name, const sax_attributes &attributes) override;
+    void end_element(const std::string &name) override;
+    void characters(const std::string &text) override;
+
+    /// <summary>
+    /// Stop the handler from changing the workbook while parsing so that several
+    /// worksheets of one workbook can be parsed at once on different threads.
+    /// Formats and strings that would be added to the workbook, and the merged
+    /// cells which depend on them, are held until apply_workbook_changes is called.
+    /// This must be called before parsing starts.
+    /// </summary>
+    void defer_workbook_changes();
+
+    /// <summary>
+    /// Make the changes held since defer_workbook_changes was called, in the order
+    /// they would have been made otherwise. format_ids caches the workbook format
+    /// id of each format in the stylesheet and can be shared by the handlers of
+    /// every worksheet in a workbook.
+    /// </summary>
+    void apply_workbook_changes(std::vector<std::size_t> &format_ids);
+
+protected:
+    /// <summary>
+    /// Return the cell that the value read for reference should be stored in.
+    /// By default this is the cell of the worksheet itself.
+    /// </summary>
+    virtual cell target_cell(const cell_reference &reference);
+
+    /// <summary>
+    /// Called after every cell of row has been stored.
+    /// </summary>
+    virtual void end_row(row_t row);
+
+    worksheet sheet_;
+
+    /// <summary>
+    /// If true, only cells are read. Column and row properties, merged cells
+    /// and the auto filter are skipped.
+    /// </summary>
+    bool cells_only_ = false;
+
+    /// <summary>
+    /// Set once the start tag of sheetData has been parsed.
+    /// </summary>
+    bool sheet_data_started_ = false;
+
+    /// <summary>
+    /// The ref attribute of dimension, or an empty string if it hasn't been seen.
+    /// </summary>
+    std::string dimension_;
+
+private:
+    struct cell_data
+    {
+        cell_reference reference;
+        bool has_value;
+        std::string value;
+        std::string type;
+        bool has_format;
+        std::size_t format_id;
+        bool has_formula;
+        bool has_shared_formula;
+        std::string formula;
+        std::string inline_string;
+    };
+
+    void start_cell(const sax_attributes &attributes);
+    void start_cell_child(const std::string &name, const sax_attributes &attributes);
+    void read_column_properties(const sax_attributes &attributes);
+    void flush_row();
+
+    struct deferred_cell
+    {
+        cell_impl *cell;
+        bool has_format;
+        std::size_t format_id;
+        bool has_string;
+        std::size_t string_index;
+    };
+
+    stylesheet &stylesheet_;
+    std::vector<text> &shared_strings_;
+
+    row_t row_ = 0;
+    std::vector<cell_data> cells_;
+    std::size_t cell_count_ = 0;
+
+    bool in_cell_ = false;
+    bool in_inline_string_ = false;
+    bool in_phonetic_run_ = false;
+    std::string *target_ = nullptr;
+
+    // mergeCell elements still expected, if mergeCells gave a count
+    bool has_merge_count_ = false;
+    long long merge_count_ = 0;
+
+    bool defer_workbook_changes_ = false;
+    std::vector<deferred_cell> deferred_cells_;
+    std::vector<std::string> deferred_strings_;
+    std::vector<range_reference> deferred_merges_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -26,13 +26,17 @@
 #include <cmath>
 #include <pugixml.hpp>
 #include <sstream>
+#include <stdexcept>
 
 #include <detail/constants.hpp>
 #include <detail/stylesheet.hpp>
 #include <detail/worksheet_serializer.hpp>
+#include <detail/worksheet_impl.hpp>
+#include <detail/worksheet_sax_handler.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/cell/text.hpp>
+#include <xlnt/packaging/zip_file.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
@@ -56,173 +60,72 @@ worksheet_serializer::worksheet_serializer(worksheet sheet) : sheet_(sheet)
 {
 }
 
-bool worksheet_serializer::read_worksheet(const pugi::xml_document &xml, detail::stylesheet &stylesheet)
+bool worksheet_serializer::read_worksheet(zip_file &archive, const std::string &part, detail::stylesheet &stylesheet)
 {
-    auto root_node = xml.child("worksheet");
+    detail::worksheet_sax_handler handler(sheet_, stylesheet);
+    detail::xml_sax_parser parser(handler);
 
-    auto dimension_node = root_node.child("dimension");
-    std::string dimension(dimension_node.attribute("ref").value());
-    auto full_range = xlnt::range_reference(dimension);
-    auto sheet_data_node = root_node.child("sheetData");
+    archive.read(part, [&parser](const char *data, std::size_t size) { parser.feed(data, size); });
+    parser.finish();
 
-    if (root_node.child("mergeCells"))
-    {
-        auto merge_cells_node = root_node.child("mergeCells");
-        auto count = std::stoull(merge_cells_node.attribute("count").value());
-
-        for (auto merge_cell_node : merge_cells_node.children("mergeCell"))
-        {
-            sheet_.merge_cells(range_reference(merge_cell_node.attribute("ref").value()));
-            count--;
-        }
+    return true;
+}
 
-        if (count != 0)
-        {
-            throw std::runtime_error("mismatch between count and actual number of merged cells");
-        }
-    }
+void worksheet_serializer::defer_worksheet(const std::string &part)
+{
+    sheet_.d_->source_part_ = part;
+    sheet_.d_->row_reader_.reset();
+}
 
-    auto &shared_strings = sheet_.get_workbook().get_shared_strings();
+void worksheet_serializer::mark_unmodified(const std::string &part)
+{
+    sheet_.d_->unmodified_part_ = part;
+}
 
-    for (auto row_node : sheet_data_node.children("row"))
+bool worksheet_serializer::copy_worksheet(zip_file &source, zip_file &archive, const std::string &part) const
+{
+    // the sheet may be saved as a different part if sheets were reordered
+    if (sheet_.d_->unmodified_part_ != part)
     {
-        auto row_index = static_cast<row_t>(std::stoull(row_node.attribute("r").value()));
-
-        if (row_node.attribute("ht"))
-        {
-            sheet_.get_row_properties(row_index).height = std::stold(row_node.attribute("ht").value());
-        }
-
-        std::string span_string = row_node.attribute("spans").value();
-        auto colon_index = span_string.find(':');
-
-        column_t min_column = 0;
-        column_t max_column = 0;
-
-        if (colon_index != std::string::npos)
-        {
-            min_column = static_cast<column_t::index_t>(std::stoll(span_string.substr(0, colon_index)));
-            max_column = static_cast<column_t::index_t>(std::stoll(span_string.substr(colon_index + 1)));
-        }
-        else
-        {
-            min_column = full_range.get_top_left().get_column_index();
-            max_column = full_range.get_bottom_right().get_column_index();
-        }
-
-        for (column_t i = min_column; i <= max_column; i++)
-        {
-            std::string address = i.column_string() + std::to_string(row_index);
-
-            pugi::xml_node cell_node;
-            bool cell_found = false;
-
-            for (auto &check_cell_node : row_node.children("c"))
-            {
-                if (check_cell_node.attribute("r") && check_cell_node.attribute("r").value() == address)
-                {
-                    cell_node = check_cell_node;
-                    cell_found = true;
-                    break;
-                }
-            }
-
-            if (cell_found)
-            {
-                bool has_value = cell_node.child("v") != nullptr;
-                std::string value_string = has_value ? cell_node.child("v").text().get() : "";
-
-                bool has_type = cell_node.attribute("t") != nullptr;
-                std::string type = has_type ? cell_node.attribute("t").value() : "";
-
-                bool has_format = cell_node.attribute("s") != nullptr;
-                auto format_id = static_cast<std::size_t>(has_format ? std::stoull(cell_node.attribute("s").value()) : 0LL);
-
-                bool has_formula = cell_node.child("f") != nullptr;
-                bool has_shared_formula = has_formula && cell_node.child("f").attribute("t") != nullptr
-                    && cell_node.child("f").attribute("t").value() == std::string("shared");
-
-                auto cell = sheet_.get_cell(address);
-
-                if (has_formula && !has_shared_formula && !sheet_.get_workbook().get_data_only())
-                {
-                    std::string formula = cell_node.child("f").text().get();
-                    cell.set_formula(formula);
-                }
-
-                if (has_type && type == "inlineStr") // inline string
-                {
-                    std::string inline_string = cell_node.child("is").child("t").text().get();
-                    cell.set_value(inline_string);
-                }
-                else if (has_type && type == "s" && !has_formula) // shared string
-                {
-                    auto shared_string_index = static_cast<std::size_t>(std::stoull(value_string));
-                    auto shared_string = shared_strings.at(shared_string_index);
-                    cell.set_value(shared_string);
-                }
-                else if (has_type && type == "b") // boolean
-                {
-                    cell.set_value(value_string != "0");
-                }
-                else if (has_type && type == "str")
-                {
-                    cell.set_value(value_string);
-                }
-                else if (has_value && !value_string.empty())
-                {
-                    if (!value_string.empty() && value_string[0] == '#')
-                    {
-                        cell.set_error(value_string);
-                    }
-                    else
-                    {
-                        cell.set_value(std::stold(value_string));
-                    }
-                }
-
-                if (has_format)
-                {
-                    cell.set_format(stylesheet.formats.at(format_id));
-                }
-            }
-        }
+        return false;
     }
 
-    auto cols_node = root_node.child("cols");
+    archive.copy_member(source, part);
 
-    for (auto col_node : cols_node.children("col"))
-    {
-        auto min = static_cast<column_t::index_t>(std::stoull(col_node.attribute("min").value()));
-        auto max = static_cast<column_t::index_t>(std::stoull(col_node.attribute("max").value()));
-        auto width = std::stold(col_node.attribute("width").value());
-        bool custom = col_node.attribute("customWidth").value() == std::string("1");
-        auto column_style = static_cast<std::size_t>(col_node.attribute("style") ? std::stoull(col_node.attribute("style").value()) : 0);
+    return true;
+}
 
-        for (auto column = min; column <= max; column++)
-        {
-            if (!sheet_.has_column_properties(column))
-            {
-                sheet_.add_column_properties(column, column_properties());
-            }
+void worksheet_serializer::write_worksheet(pugi::xml_document &xml) const
+{
+    std::unordered_map<std::string, std::string> hyperlink_references;
+    write_worksheet(xml, true, hyperlink_references);
+}
 
-            sheet_.get_column_properties(min).width = width;
-            sheet_.get_column_properties(min).style = column_style;
-            sheet_.get_column_properties(min).custom = custom;
-        }
-    }
+void worksheet_serializer::write_worksheet_skeleton(pugi::xml_document &xml,
+    const std::unordered_map<std::string, std::string> &hyperlink_references) const
+{
+    auto references = hyperlink_references;
+    write_worksheet(xml, false, references);
+}
 
-    if (root_node.child("autoFilter"))
+void worksheet_serializer::write_worksheet(zip_file &archive, const std::string &part) const
+{
+    if (sheet_.d_->row_writer_)
     {
-        auto auto_filter_node = root_node.child("autoFilter");
-        xlnt::range_reference ref(auto_filter_node.attribute("ref").value());
-        sheet_.auto_filter(ref);
+        sheet_.d_->row_writer_->save(sheet_, archive, part);
+        return;
     }
 
-    return true;
+    pugi::xml_document worksheet_xml;
+    write_worksheet(worksheet_xml);
+
+    std::ostringstream ss;
+    worksheet_xml.save(ss);
+    archive.writestr(part, ss.str());
 }
 
-void worksheet_serializer::write_worksheet(pugi::xml_document &xml) const
+void worksheet_serializer::write_worksheet(pugi::xml_document &xml, bool write_cells,
+    std::unordered_map<std::string, std::string> &hyperlink_references) const
 {
     auto root_node = xml.append_child("worksheet");
 
@@ -242,8 +145,11 @@ void worksheet_serializer::write_worksheet(pugi::xml_document &xml) const
         page_set_up_pr_node.append_attribute("fitToPage").set_value(sheet_.get_page_setup().fit_to_page() ? "1" : "0");
     }
 
-    auto dimension_node = root_node.append_child("dimension");
-    dimension_node.append_attribute("ref").set_value(sheet_.calculate_dimension().to_string().c_str());
+    if (write_cells)
+    {
+        auto dimension_node = root_node.append_child("dimension");
+        dimension_node.append_attribute("ref").set_value(sheet_.calculate_dimension().to_string().c_str());
+    }
 
     auto sheet_views_node = root_node.append_child("sheetViews");
     auto sheet_view_node = sheet_views_node.append_child("sheetView");
@@ -307,28 +213,29 @@ void worksheet_serializer::write_worksheet(pugi::xml_document &xml) const
     sheet_format_pr_node.append_attribute("baseColWidth").set_value("10");
     sheet_format_pr_node.append_attribute("defaultRowHeight").set_value("15");
 
-    bool has_column_properties = false;
+    // Without the cells, the extents of the sheet aren't known so every column
+    // with properties is written.
+    auto lowest_column = write_cells ? sheet_.get_lowest_column() : constants::min_column();
+    auto highest_column = write_cells ? sheet_.get_highest_column() : constants::max_column();
+
+    std::vector<column_t> columns;
 
-    for (auto column = sheet_.get_lowest_column(); column <= sheet_.get_highest_column(); column++)
+    for (const auto &column_properties : sheet_.d_->column_properties_)
     {
-        if (sheet_.has_column_properties(column))
+        if (column_properties.first >= lowest_column && column_properties.first <= highest_column)
         {
-            has_column_properties = true;
-            break;
+            columns.push_back(column_properties.first);
         }
     }
 
-    if (has_column_properties)
+    std::sort(columns.begin(), columns.end());
+
+    if (!columns.empty())
     {
         auto cols_node = root_node.append_child("cols");
 
-        for (auto column = sheet_.get_lowest_column(); column <= sheet_.get_highest_column(); column++)
+        for (auto column : columns)
         {
-            if(!sheet_.has_column_properties(column))
-            {
-                continue;
-            }
-            
             const auto &props = sheet_.get_column_properties(column);
 
             auto col_node = cols_node.append_child("col");
@@ -341,9 +248,125 @@ void worksheet_serializer::write_worksheet(pugi::xml_document &xml) const
         }
     }
 
-    std::unordered_map<std::string, std::string> hyperlink_references;
-
     auto sheet_data_node = root_node.append_child("sheetData");
+
+    if (write_cells)
+    {
+        write_rows(sheet_data_node, hyperlink_references);
+    }
+
+    if (sheet_.has_auto_filter())
+    {
+        auto auto_filter_node = root_node.append_child("autoFilter");
+        auto_filter_node.append_attribute("ref").set_value(sheet_.get_auto_filter().to_string().c_str());
+    }
+
+    if (!sheet_.get_merged_ranges().empty())
+    {
+        auto merge_cells_node = root_node.append_child("mergeCells");
+        merge_cells_node.append_attribute("count").set_value(std::to_string(sheet_.get_merged_ranges().size()).c_str());
+
+        for (auto merged_range : sheet_.get_merged_ranges())
+        {
+            auto merge_cell_node = merge_cells_node.append_child("mergeCell");
+            merge_cell_node.append_attribute("ref").set_value(merged_range.to_string().c_str());
+        }
+    }
+
+    if (!sheet_.get_relationships().empty())
+    {
+        auto hyperlinks_node = root_node.append_child("hyperlinks");
+
+        for (const auto &relationship : sheet_.get_relationships())
+        {
+            // A skeleton written before the rows in optimized write mode doesn't know
+            // where hyperlinks are yet. Its part after sheetData is only used once
+            // every row has been written, at which point they're all known.
+            if (!write_cells && hyperlink_references.find(relationship.get_id()) == hyperlink_references.end())
+            {
+                continue;
+            }
+
+            auto hyperlink_node = hyperlinks_node.append_child("hyperlink");
+            hyperlink_node.append_attribute("display").set_value(relationship.get_target_uri().c_str());
+            hyperlink_node.append_attribute("ref").set_value(hyperlink_references.at(relationship.get_id()).c_str());
+            hyperlink_node.append_attribute("r:id").set_value(relationship.get_id().c_str());
+        }
+    }
+
+    if (!sheet_.get_page_setup().is_default())
+    {
+        auto print_options_node = root_node.append_child("printOptions");
+        print_options_node.append_attribute("horizontalCentered").set_value(
+                                         sheet_.get_page_setup().get_horizontal_centered() ? "1" : "0");
+        print_options_node.append_attribute("verticalCentered").set_value(
+                                         sheet_.get_page_setup().get_vertical_centered() ? "1" : "0");
+    }
+
+    auto page_margins_node = root_node.append_child("pageMargins");
+    
+    //TODO: there must be a better way to do this
+    auto remove_trailing_zeros = [](const std::string &n)
+    {
+        auto decimal = n.find('.');
+        
+        if (decimal == std::string::npos) return n;
+        
+        auto index = n.size() - 1;
+        
+        while (index >= decimal && n[index] == '0')
+        {
+            index--;
+        }
+        
+        if(index == decimal)
+        {
+            return n.substr(0, decimal);
+        }
+        
+        return n.substr(0, index + 1);
+    };
+
+    page_margins_node.append_attribute("left").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_left())).c_str());
+    page_margins_node.append_attribute("right").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_right())).c_str());
+    page_margins_node.append_attribute("top").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_top())).c_str());
+    page_margins_node.append_attribute("bottom").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_bottom())).c_str());
+    page_margins_node.append_attribute("header").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_header())).c_str());
+    page_margins_node.append_attribute("footer").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_footer())).c_str());
+
+    if (!sheet_.get_page_setup().is_default())
+    {
+        auto page_setup_node = root_node.append_child("pageSetup");
+
+        std::string orientation_string =
+            sheet_.get_page_setup().get_orientation() == orientation::landscape ? "landscape" : "portrait";
+        page_setup_node.append_attribute("orientation").set_value(orientation_string.c_str());
+        page_setup_node.append_attribute("paperSize").set_value(
+                                      std::to_string(static_cast<int>(sheet_.get_page_setup().get_paper_size())).c_str());
+        page_setup_node.append_attribute("fitToHeight").set_value(sheet_.get_page_setup().fit_to_height() ? "1" : "0");
+        page_setup_node.append_attribute("fitToWidth").set_value(sheet_.get_page_setup().fit_to_width() ? "1" : "0");
+    }
+
+    if (!sheet_.get_header_footer().is_default())
+    {
+        auto header_footer_node = root_node.append_child("headerFooter");
+        auto odd_header_node = header_footer_node.append_child("oddHeader");
+        std::string header_text =
+            "&L&\"Calibri,Regular\"&K000000Left Header Text&C&\"Arial,Regular\"&6&K445566Center Header "
+            "Text&R&\"Arial,Bold\"&8&K112233Right Header Text";
+        odd_header_node.text().set(header_text.c_str());
+        auto odd_footer_node = header_footer_node.append_child("oddFooter");
+        std::string footer_text =
+            "&L&\"Times New Roman,Regular\"&10&K445566Left Footer Text_x000D_And &D and &T&C&\"Times New "
+            "Roman,Bold\"&12&K778899Center Footer Text &Z&F on &A&R&\"Times New Roman,Italic\"&14&KAABBCCRight Footer "
+            "Text &P of &N";
+        odd_footer_node.text().set(footer_text.c_str());
+    }
+}
+
+void worksheet_serializer::write_rows(pugi::xml_node sheet_data_node,
+    std::unordered_map<std::string, std::string> &hyperlink_references) const
+{
     const auto &shared_strings = sheet_.get_workbook().get_shared_strings();
 
     for (auto row : sheet_.rows())
@@ -413,35 +436,25 @@ void worksheet_serializer::write_worksheet(pugi::xml_document &xml) const
                         continue;
                     }
 
-                    int match_index = -1;
+                    // string cells already hold their index in the shared string table
+                    auto string_index = cell.d_->value_string_;
 
-                    for (std::size_t i = 0; i < shared_strings.size(); i++)
+                    if (string_index == detail::cell_impl::empty_string)
                     {
-                        if (shared_strings[i] == cell.get_value<text>())
-                        {
-                            match_index = static_cast<int>(i);
-                            break;
-                        }
+                        // the empty string isn't in the table
+                        cell_node.append_attribute("t").set_value("inlineStr");
+                        cell_node.append_child("is").append_child("t");
                     }
-
-                    if (match_index == -1)
+                    else if (string_index < shared_strings.size())
                     {
-                        if (cell.get_value<std::string>().empty())
-                        {
-                            cell_node.append_attribute("t").set_value("s");
-                        }
-                        else
-                        {
-                            cell_node.append_attribute("t").set_value("inlineStr");
-                            auto inline_string_node = cell_node.append_child("is");
-                            inline_string_node.append_child("t").text().set(cell.get_value<std::string>().c_str());
-                        }
+                        cell_node.append_attribute("t").set_value("s");
+                        auto value_node = cell_node.append_child("v");
+                        value_node.text().set(std::to_string(string_index).c_str());
                     }
                     else
                     {
-                        cell_node.append_attribute("t").set_value("s");
-                        auto value_node = cell_node.append_child("v");
-                        value_node.text().set(std::to_string(match_index).c_str());
+                        throw std::runtime_error("cell " + cell.get_reference().to_string()
+                            + " refers to a shared string which doesn't exist");
                     }
                 }
                 else
@@ -495,106 +508,6 @@ void worksheet_serializer::write_worksheet(pugi::xml_document &xml) const
             }
         }
     }
-
-    if (sheet_.has_auto_filter())
-    {
-        auto auto_filter_node = root_node.append_child("autoFilter");
-        auto_filter_node.append_attribute("ref").set_value(sheet_.get_auto_filter().to_string().c_str());
-    }
-
-    if (!sheet_.get_merged_ranges().empty())
-    {
-        auto merge_cells_node = root_node.append_child("mergeCells");
-        merge_cells_node.append_attribute("count").set_value(std::to_string(sheet_.get_merged_ranges().size()).c_str());
-
-        for (auto merged_range : sheet_.get_merged_ranges())
-        {
-            auto merge_cell_node = merge_cells_node.append_child("mergeCell");
-            merge_cell_node.append_attribute("ref").set_value(merged_range.to_string().c_str());
-        }
-    }
-
-    if (!sheet_.get_relationships().empty())
-    {
-        auto hyperlinks_node = root_node.append_child("hyperlinks");
-
-        for (const auto &relationship : sheet_.get_relationships())
-        {
-            auto hyperlink_node = hyperlinks_node.append_child("hyperlink");
-            hyperlink_node.append_attribute("display").set_value(relationship.get_target_uri().c_str());
-            hyperlink_node.append_attribute("ref").set_value(hyperlink_references.at(relationship.get_id()).c_str());
-            hyperlink_node.append_attribute("r:id").set_value(relationship.get_id().c_str());
-        }
-    }
-
-    if (!sheet_.get_page_setup().is_default())
-    {
-        auto print_options_node = root_node.append_child("printOptions");
-        print_options_node.append_attribute("horizontalCentered").set_value(
-                                         sheet_.get_page_setup().get_horizontal_centered() ? "1" : "0");
-        print_options_node.append_attribute("verticalCentered").set_value(
-                                         sheet_.get_page_setup().get_vertical_centered() ? "1" : "0");
-    }
-
-    auto page_margins_node = root_node.append_child("pageMargins");
-    
-    //TODO: there must be a better way to do this
-    auto remove_trailing_zeros = [](const std::string &n)
-    {
-        auto decimal = n.find('.');
-        
-        if (decimal == std::string::npos) return n;
-        
-        auto index = n.size() - 1;
-        
-        while (index >= decimal && n[index] == '0')
-        {
-            index--;
-        }
-        
-        if(index == decimal)
-        {
-            return n.substr(0, decimal);
-        }
-        
-        return n.substr(0, index + 1);
-    };
-
-    page_margins_node.append_attribute("left").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_left())).c_str());
-    page_margins_node.append_attribute("right").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_right())).c_str());
-    page_margins_node.append_attribute("top").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_top())).c_str());
-    page_margins_node.append_attribute("bottom").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_bottom())).c_str());
-    page_margins_node.append_attribute("header").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_header())).c_str());
-    page_margins_node.append_attribute("footer").set_value(remove_trailing_zeros(std::to_string(sheet_.get_page_margins().get_footer())).c_str());
-
-    if (!sheet_.get_page_setup().is_default())
-    {
-        auto page_setup_node = root_node.append_child("pageSetup");
-
-        std::string orientation_string =
-            sheet_.get_page_setup().get_orientation() == orientation::landscape ? "landscape" : "portrait";
-        page_setup_node.append_attribute("orientation").set_value(orientation_string.c_str());
-        page_setup_node.append_attribute("paperSize").set_value(
-                                      std::to_string(static_cast<int>(sheet_.get_page_setup().get_paper_size())).c_str());
-        page_setup_node.append_attribute("fitToHeight").set_value(sheet_.get_page_setup().fit_to_height() ? "1" : "0");
-        page_setup_node.append_attribute("fitToWidth").set_value(sheet_.get_page_setup().fit_to_width() ? "1" : "0");
-    }
-
-    if (!sheet_.get_header_footer().is_default())
-    {
-        auto header_footer_node = root_node.append_child("headerFooter");
-        auto odd_header_node = header_footer_node.append_child("oddHeader");
-        std::string header_text =
-            "&L&\"Calibri,Regular\"&K000000Left Header Text&C&\"Arial,Regular\"&6&K445566Center Header "
-            "Text&R&\"Arial,Bold\"&8&K112233Right Header Text";
-        odd_header_node.text().set(header_text.c_str());
-        auto odd_footer_node = header_footer_node.append_child("oddFooter");
-        std::string footer_text =
-            "&L&\"Times New Roman,Regular\"&10&K445566Left Footer Text_x000D_And &D and &T&C&\"Times New "
-            "Roman,Bold\"&12&K778899Center Footer Text &Z&F on &A&R&\"Times New Roman,Italic\"&14&KAABBCCRight Footer "
-            "Text &P of &N";
-        odd_footer_node.text().set(footer_text.c_str());
-    }
 }
 
 } // namespace xlnt
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
@@ -31,6 +32,7 @@
 
 namespace pugi {
 class xml_document;
+class xml_node;
 } // namespace pugi
 
 namespace xlnt {
@@ -38,6 +40,7 @@ namespace xlnt {
 class relationship;
 class workbook;
 class worksheet;
+class zip_file;
 
 namespace detail { struct stylesheet; }
 
@@ -49,10 +52,58 @@ class XLNT_CLASS worksheet_serializer
 public:
     worksheet_serializer(worksheet sheet);
 
-    bool read_worksheet(const pugi::xml_document &xml, detail::stylesheet &stylesheet);
+    /// <summary>
+    /// Read the worksheet stored in the given part of archive. The part is inflated
+    /// and parsed incrementally so no DOM or decompressed copy of it is ever built.
+    /// </summary>
+    bool read_worksheet(zip_file &archive, const std::string &part, detail::stylesheet &stylesheet);
+
+    /// <summary>
+    /// Record the part holding this worksheet without reading it. Cells are then
+    /// streamed from the workbook's source archive when they are accessed.
+    /// </summary>
+    void defer_worksheet(const std::string &part);
+
+    /// <summary>
+    /// Record that the worksheet was just loaded from the given part so that it
+    /// can be copied by copy_worksheet until it's modified.
+    /// </summary>
+    void mark_unmodified(const std::string &part);
+
+    /// <summary>
+    /// If the worksheet hasn't been modified since it was loaded from part of
+    /// source, copy its compressed contents to the same part of archive and
+    /// return true. Otherwise return false and leave archive alone.
+    /// </summary>
+    bool copy_worksheet(zip_file &source, zip_file &archive, const std::string &part) const;
+
     void write_worksheet(pugi::xml_document &xml) const;
 
+    /// <summary>
+    /// Write the worksheet to part of archive. Worksheets of workbooks in optimized
+    /// write mode are completed from the rows already streamed by worksheet::append.
+    /// </summary>
+    void write_worksheet(zip_file &archive, const std::string &part) const;
+
+    /// <summary>
+    /// Write everything but the cells of the worksheet, leaving sheetData empty.
+    /// hyperlink_references maps relationship ids to the cells which were written
+    /// separately with write_rows.
+    /// </summary>
+    void write_worksheet_skeleton(pugi::xml_document &xml,
+        const std::unordered_map<std::string, std::string> &hyperlink_references) const;
+
+    /// <summary>
+    /// Append a row node to sheet_data_node for each row of the worksheet containing
+    /// a non-empty cell, recording the references of cells with hyperlinks.
+    /// </summary>
+    void write_rows(pugi::xml_node sheet_data_node,
+        std::unordered_map<std::string, std::string> &hyperlink_references) const;
+
 private:
+    void write_worksheet(pugi::xml_document &xml, bool write_cells,
+        std::unordered_map<std::string, std::string> &hyperlink_references) const;
+
     worksheet sheet_;
 };
 
@@ -0,0 +1,490 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <cstring>
+#include <stdexcept>
+
+#include <detail/xml_sax_parser.hpp>
+
+namespace {
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void append_utf8(unsigned long code_point, std::string &out)
+{
+    if (code_point < 0x80)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+/// <summary>
+/// Return the code point of a character reference given what follows "&#",
+/// either decimal digits or 'x' and hexadecimal digits.
+/// </summary>
+unsigned long parse_character_reference(const char *reference, std::size_t length)
+{
+    bool hex = length > 0 && reference[0] == 'x';
+    auto digit = reference + (hex ? 1 : 0);
+    auto digits_end = reference + length;
+
+    if (digit == digits_end)
+    {
+        throw std::runtime_error("xml: empty character reference");
+    }
+
+    unsigned long code_point = 0;
+
+    for (; digit != digits_end; ++digit)
+    {
+        auto c = *digit;
+        unsigned long value = 0;
+
+        if (c >= '0' && c <= '9') value = static_cast<unsigned long>(c - '0');
+        else if (hex && c >= 'a' && c <= 'f') value = static_cast<unsigned long>(c - 'a' + 10);
+        else if (hex && c >= 'A' && c <= 'F') value = static_cast<unsigned long>(c - 'A' + 10);
+        else throw std::runtime_error("xml: invalid digit in character reference");
+
+        code_point = code_point * (hex ? 16 : 10) + value;
+
+        // checked as each digit is added so long references can't overflow
+        if (code_point > 0x10FFFF)
+        {
+            throw std::runtime_error("xml: character reference out of range");
+        }
+    }
+
+    if (code_point == 0 || (code_point >= 0xD800 && code_point <= 0xDFFF))
+    {
+        throw std::runtime_error("xml: character reference out of range");
+    }
+
+    return code_point;
+}
+
+/// <summary>
+/// Append the expansion of the reference between '&' and ';' to out.
+/// Unknown entities are kept verbatim.
+/// </summary>
+void append_reference(const char *reference, std::size_t length, std::string &out)
+{
+    auto matches = [&](const char *entity) {
+        return std::strlen(entity) == length && std::strncmp(reference, entity, length) == 0;
+    };
+
+    if (matches("lt")) out.push_back('<');
+    else if (matches("gt")) out.push_back('>');
+    else if (matches("amp")) out.push_back('&');
+    else if (matches("quot")) out.push_back('"');
+    else if (matches("apos")) out.push_back('\'');
+    else if (length > 0 && reference[0] == '#')
+    {
+        append_utf8(parse_character_reference(reference + 1, length - 1), out);
+    }
+    else
+    {
+        out.push_back('&');
+        out.append(reference, length);
+        out.push_back(';');
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+const std::string *sax_attributes::find(const char *name) const
+{
+    for (std::size_t i = 0; i < size_; i++)
+    {
+        if (attributes_[i].name == name)
+        {
+            return &attributes_[i].value;
+        }
+    }
+
+    return nullptr;
+}
+
+std::size_t sax_attributes::size() const
+{
+    return size_;
+}
+
+const sax_attribute &sax_attributes::operator[](std::size_t index) const
+{
+    return attributes_.at(index);
+}
+
+void sax_attributes::clear()
+{
+    size_ = 0;
+}
+
+sax_attribute &sax_attributes::add()
+{
+    if (size_ == attributes_.size())
+    {
+        attributes_.emplace_back();
+    }
+
+    return attributes_[size_++];
+}
+
+sax_handler::~sax_handler()
+{
+}
+
+xml_sax_parser::xml_sax_parser(sax_handler &handler) : handler_(handler)
+{
+}
+
+void xml_sax_parser::feed(const char *data, std::size_t size)
+{
+    buffer_.append(data, size);
+
+    std::size_t position = 0;
+
+    while (position < buffer_.size())
+    {
+        std::size_t next = std::string::npos;
+
+        if (buffer_[position] == '<')
+        {
+            next = parse_markup(position);
+        }
+        else
+        {
+            next = buffer_.find('<', position);
+
+            if (next != std::string::npos)
+            {
+                emit_characters(position, next);
+            }
+        }
+
+        if (next == std::string::npos)
+        {
+            break;
+        }
+
+        position = next;
+    }
+
+    buffer_.erase(0, position);
+}
+
+void xml_sax_parser::finish()
+{
+    for (auto c : buffer_)
+    {
+        if (!is_space(c))
+        {
+            throw std::runtime_error("xml: unexpected end of document");
+        }
+    }
+
+    if (depth_ != 0)
+    {
+        throw std::runtime_error("xml: unclosed element");
+    }
+
+    buffer_.clear();
+}
+
+std::size_t xml_sax_parser::parse_markup(std::size_t position)
+{
+    const auto npos = std::string::npos;
+    auto remaining = buffer_.size() - position;
+
+    if (remaining < 2)
+    {
+        return npos;
+    }
+
+    if (buffer_[position + 1] == '?')
+    {
+        auto end = buffer_.find("?>", position + 2);
+        return end == npos ? npos : end + 2;
+    }
+
+    if (buffer_[position + 1] == '!')
+    {
+        if (remaining < 4)
+        {
+            return npos;
+        }
+
+        if (buffer_.compare(position, 4, "<!--") == 0)
+        {
+            auto end = buffer_.find("-->", position + 4);
+            return end == npos ? npos : end + 3;
+        }
+
+        if (remaining < 9)
+        {
+            return npos;
+        }
+
+        if (buffer_.compare(position, 9, "<![CDATA[") == 0)
+        {
+            auto end = buffer_.find("]]>", position + 9);
+
+            if (end == npos)
+            {
+                return npos;
+            }
+
+            text_.assign(buffer_, position + 9, end - position - 9);
+            handler_.characters(text_);
+
+            return end + 3;
+        }
+
+        auto end = buffer_.find('>', position + 2);
+        return end == npos ? npos : end + 1;
+    }
+
+    // find the closing '>', which may legally appear inside quoted attribute values
+    char quote = 0;
+
+    for (auto end = position + 1; end < buffer_.size(); end++)
+    {
+        auto c = buffer_[end];
+
+        if (quote != 0)
+        {
+            if (c == quote)
+            {
+                quote = 0;
+            }
+        }
+        else if (c == '"' || c == '\'')
+        {
+            quote = c;
+        }
+        else if (c == '>')
+        {
+            parse_tag(position + 1, end);
+            return end + 1;
+        }
+    }
+
+    return npos;
+}
+
+void xml_sax_parser::parse_tag(std::size_t begin, std::size_t end)
+{
+    if (begin < end && buffer_[begin] == '/')
+    {
+        auto name_end = begin + 1;
+
+        while (name_end < end && !is_space(buffer_[name_end]))
+        {
+            name_end++;
+        }
+
+        if (depth_ == 0)
+        {
+            throw std::runtime_error("xml: unexpected end tag");
+        }
+
+        name_.assign(buffer_, begin + 1, name_end - begin - 1);
+        depth_--;
+        handler_.end_element(name_);
+
+        return;
+    }
+
+    bool empty_element = end > begin && buffer_[end - 1] == '/';
+
+    if (empty_element)
+    {
+        end--;
+    }
+
+    auto i = begin;
+
+    while (i < end && !is_space(buffer_[i]))
+    {
+        i++;
+    }
+
+    if (i == begin)
+    {
+        throw std::runtime_error("xml: expected element name");
+    }
+
+    name_.assign(buffer_, begin, i - begin);
+    attributes_.clear();
+
+    while (true)
+    {
+        while (i < end && is_space(buffer_[i]))
+        {
+            i++;
+        }
+
+        if (i >= end)
+        {
+            break;
+        }
+
+        auto name_begin = i;
+
+        while (i < end && buffer_[i] != '=' && !is_space(buffer_[i]))
+        {
+            i++;
+        }
+
+        auto &attribute = attributes_.add();
+        attribute.name.assign(buffer_, name_begin, i - name_begin);
+
+        while (i < end && is_space(buffer_[i]))
+        {
+            i++;
+        }
+
+        if (i >= end || buffer_[i] != '=')
+        {
+            throw std::runtime_error("xml: expected '=' after attribute " + attribute.name);
+        }
+
+        i++;
+
+        while (i < end && is_space(buffer_[i]))
+        {
+            i++;
+        }
+
+        if (i >= end || (buffer_[i] != '"' && buffer_[i] != '\''))
+        {
+            throw std::runtime_error("xml: expected quoted value for attribute " + attribute.name);
+        }
+
+        auto quote = buffer_[i++];
+        auto value_end = buffer_.find(quote, i);
+
+        if (value_end == std::string::npos || value_end > end)
+        {
+            throw std::runtime_error("xml: unterminated value for attribute " + attribute.name);
+        }
+
+        unescape(i, value_end, true, attribute.value);
+        i = value_end + 1;
+    }
+
+    depth_++;
+    handler_.start_element(name_, attributes_);
+
+    if (empty_element)
+    {
+        depth_--;
+        handler_.end_element(name_);
+    }
+}
+
+void xml_sax_parser::emit_characters(std::size_t begin, std::size_t end)
+{
+    // whitespace outside of the root element isn't character data
+    if (begin == end || depth_ == 0)
+    {
+        return;
+    }
+
+    unescape(begin, end, false, text_);
+    handler_.characters(text_);
+}
+
+void xml_sax_parser::unescape(std::size_t begin, std::size_t end, bool attribute, std::string &out)
+{
+    out.clear();
+    auto run_begin = begin;
+
+    for (auto i = begin; i < end; i++)
+    {
+        auto c = buffer_[i];
+
+        if (c == '&')
+        {
+            auto semicolon = buffer_.find(';', i);
+
+            if (semicolon == std::string::npos || semicolon >= end)
+            {
+                throw std::runtime_error("xml: unterminated character reference");
+            }
+
+            out.append(buffer_, run_begin, i - run_begin);
+            append_reference(buffer_.data() + i + 1, semicolon - i - 1, out);
+            i = semicolon;
+            run_begin = i + 1;
+        }
+        else if (c == '\r')
+        {
+            // line endings are normalized to '\n', attribute whitespace to ' '
+            out.append(buffer_, run_begin, i - run_begin);
+            out.push_back(attribute ? ' ' : '\n');
+
+            if (i + 1 < end && buffer_[i + 1] == '\n')
+            {
+                i++;
+            }
+
+            run_begin = i + 1;
+        }
+        else if (attribute && (c == '\n' || c == '\t'))
+        {
+            out.append(buffer_, run_begin, i - run_begin);
+            out.push_back(' ');
+            run_begin = i + 1;
+        }
+    }
+
+    out.append(buffer_, run_begin, end - run_begin);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,133 @@
+// Copyright (c) 2014-2016 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A single name="value" pair from the start tag of an element.
+/// </summary>
+struct sax_attribute
+{
+    std::string name;
+    std::string value;
+};
+
+/// <summary>
+/// The attributes of the element most recently started by an xml_sax_parser.
+/// Storage is reused between elements so that no allocation is needed once
+/// the longest names and values have been seen.
+/// </summary>
+class XLNT_CLASS sax_attributes
+{
+public:
+    /// <summary>
+    /// Return a pointer to the value of the attribute called name or nullptr
+    /// if the element doesn't have that attribute.
+    /// </summary>
+    const std::string *find(const char *name) const;
+
+    std::size_t size() const;
+    const sax_attribute &operator[](std::size_t index) const;
+
+    void clear();
+    sax_attribute &add();
+
+private:
+    std::vector<sax_attribute> attributes_;
+    std::size_t size_ = 0;
+};
+
+/// <summary>
+/// Receives events from an xml_sax_parser in document order.
+/// </summary>
+class XLNT_CLASS sax_handler
+{
+public:
+    virtual ~sax_handler();
+
+    /// <summary>
+    /// Called when a start tag or an empty-element tag is parsed.
+    /// Empty-element tags are immediately followed by a call to end_element.
+    /// </summary>
+    virtual void start_element(const std::string &name, const sax_attributes &attributes) = 0;
+
+    /// <summary>
+    /// Called when an end tag is parsed.
+    /// </summary>
+    virtual void end_element(const std::string &name) = 0;
+
+    /// <summary>
+    /// Called with the unescaped character data between two tags. CDATA sections
+    /// are reported with their own call.
+    /// </summary>
+    virtual void characters(const std::string &text) = 0;
+};
+
+/// <summary>
+/// An incremental, non-validating XML parser. The document can be given to feed
+/// in chunks of any size and each token is reported to the handler as soon as it
+/// is complete, so memory use is bounded by the longest token rather than by the
+/// size of the document. Comments, processing instructions and doctype declarations
+/// are skipped. Predefined and numeric character references are expanded.
+/// </summary>
+class XLNT_CLASS xml_sax_parser
+{
+public:
+    xml_sax_parser(sax_handler &handler);
+
+    /// <summary>
+    /// Parse as much of the document as possible after appending size bytes from data.
+    /// </summary>
+    void feed(const char *data, std::size_t size);
+
+    /// <summary>
+    /// Signal the end of the document. Throws std::runtime_error if the document
+    /// ends in the middle of a token or if any element is left open.
+    /// </summary>
+    void finish();
+
+private:
+    std::size_t parse_markup(std::size_t position);
+    void parse_tag(std::size_t position, std::size_t end);
+    void emit_characters(std::size_t begin, std::size_t end);
+    void unescape(std::size_t begin, std::size_t end, bool attribute, std::string &out);
+
+    sax_handler &handler_;
+    std::string buffer_;
+    std::string name_;
+    std::string text_;
+    sax_attributes attributes_;
+    std::size_t depth_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
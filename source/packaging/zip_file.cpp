@@ -23,10 +23,16 @@
 // @author: see AUTHORS file
 #include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <iterator>
+#include <limits>
 #include <miniz.h>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -36,7 +42,9 @@
 #include <sys/stat.h>
 #endif
 
+#include <detail/compression_backend.hpp>
 #include <detail/include_windows.hpp>
+#include <detail/mapped_file.hpp>
 #include <xlnt/packaging/zip_file.hpp>
 
 namespace {
@@ -141,51 +149,79 @@ void mkdir_recursive(const std::string path)
 #endif
 }
 
-uint32_t crc32buf(const char *buf, std::size_t len)
-{
-    uint32_t oldcrc32 = 0xFFFFFFFF;
-
-    uint32_t crc_32_tab[] = {
-        /* CRC polynomial 0xedb88320 */
-        0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3, 0x0edb8832,
-        0x79dcb8a4, 0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2,
-        0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7, 0x136c9856, 0x646ba8c0, 0xfd62f97a,
-        0x8a65c9ec, 0x14015c4f, 0x63066cd9, 0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
-        0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b, 0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940, 0x32d86ce3,
-        0x45df5c75, 0xdcd60dcf, 0xabd13d59, 0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423,
-        0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924, 0x2f6f7c87, 0x58684c11, 0xc1611dab,
-        0xb6662d3d, 0x76dc4190, 0x01db7106, 0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
-        0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01, 0x6b6b51f4,
-        0x1c6c6162, 0x856530d8, 0xf262004e, 0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-        0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65, 0x4db26158, 0x3ab551ce, 0xa3bc0074,
-        0xd4bb30e2, 0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
-        0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa, 0xbe0b1010, 0xc90c2086, 0x5768b525,
-        0x206f85b3, 0xb966d409, 0xce61e49f, 0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81,
-        0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a, 0xead54739, 0x9dd277af, 0x04db2615,
-        0x73dc1683, 0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
-        0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb, 0x196c3671, 0x6e6b06e7, 0xfed41b76,
-        0x89d32be0, 0x10da7a5a, 0x67dd4acc, 0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5, 0xd6d6a3e8, 0xa1d1937e,
-        0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b, 0xd80d2bda, 0xaf0a1b4c, 0x36034af6,
-        0x41047a60, 0xdf60efc3, 0xa867df55, 0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-        0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28, 0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7,
-        0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d, 0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f,
-        0x72076785, 0x05005713, 0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38, 0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7,
-        0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242, 0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
-        0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45, 0xa00ae278,
-        0xd70dd2ee, 0x4e048354, 0x3903b3c2, 0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc,
-        0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9, 0xbdbdf21c, 0xcabac28a, 0x53b39330,
-        0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
-        0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
-    };
+mz_uint to_miniz_level(xlnt::compression_level level)
+{
+    switch (level)
+    {
+    case xlnt::compression_level::store:
+        return MZ_NO_COMPRESSION;
+    case xlnt::compression_level::fast:
+        return MZ_BEST_SPEED;
+    case xlnt::compression_level::normal:
+        return MZ_DEFAULT_LEVEL;
+    case xlnt::compression_level::best:
+    default:
+        return MZ_BEST_COMPRESSION;
+    }
+}
+
+/// <summary>
+/// Find the end of central directory record of the archive in data and return the
+/// offset of the archive comment which follows it. The length of the comment is
+/// stored in length.
+/// </summary>
+std::size_t find_comment(const char *data, std::size_t size, std::uint16_t &length)
+{
+    std::size_t position = size - 1;
+
+    for (; position >= 3; position--)
+    {
+        if (data[position - 3] == 'P' && data[position - 2] == 'K' && data[position - 1] == '\x05' &&
+            data[position] == '\x06')
+        {
+            position = position + 17;
+            break;
+        }
+    }
+
+    if (position <= 3 || position + 2 > size)
+    {
+        throw std::runtime_error("didn't find end of central directory signature");
+    }
+
+    auto length_bytes = reinterpret_cast<const unsigned char *>(data + position);
+    length = static_cast<std::uint16_t>(length_bytes[0] | (length_bytes[1] << 8));
+
+    return position + 2;
+}
+
+/// <summary>
+/// Return the compressed data of the member described by stat in the archive in
+/// data. It follows the member's local header, which has variable length name
+/// and extra fields.
+/// </summary>
+const char *find_member_data(const char *data, std::size_t size, const mz_zip_archive_file_stat &stat)
+{
+    const std::size_t local_header_size = 30;
+    auto header_offset = static_cast<std::size_t>(stat.m_local_header_ofs);
+
+    if (header_offset + local_header_size > size
+        || std::memcmp(data + header_offset, "PK\x03\x04", 4) != 0)
+    {
+        throw std::runtime_error("bad zip");
+    }
 
-#define UPDC32(octet, crc) (crc_32_tab[((crc) ^ static_cast<uint8_t>(octet)) & 0xff] ^ ((crc) >> 8))
+    auto header = reinterpret_cast<const unsigned char *>(data + header_offset);
+    auto name_length = static_cast<std::size_t>(header[26] | (header[27] << 8));
+    auto extra_length = static_cast<std::size_t>(header[28] | (header[29] << 8));
+    auto data_offset = header_offset + local_header_size + name_length + extra_length;
 
-    for (; len; --len, ++buf)
+    if (data_offset + static_cast<std::size_t>(stat.m_comp_size) > size)
     {
-        oldcrc32 = UPDC32(*buf, oldcrc32);
+        throw std::runtime_error("bad zip");
     }
 
-    return ~oldcrc32;
+    return data + data_offset;
 }
 
 tm safe_localtime(const time_t &t)
@@ -195,33 +231,592 @@ tm safe_localtime(const time_t &t)
     localtime_s(&time, &t);
     return time;
 #else
-    tm *time = localtime(&t);
-    assert(time != nullptr);
-    return *time;
+    // localtime_r rather than localtime since archives can be read from several threads
+    tm time;
+    auto result = localtime_r(&t, &time);
+    assert(result != nullptr);
+    (void)result;
+    return time;
 #endif
 }
 
+/// <summary>
+/// Replace the contents of buffer with everything left in stream. The stream
+/// is read a large block at a time. If it can seek, the amount left is found
+/// first so it's read in one go, otherwise the block doubles each time.
+/// </summary>
+void read_all(std::istream &stream, std::vector<char> &buffer)
+{
+    const std::size_t first_block_size = 65536;
+    buffer.clear();
+
+    auto start = stream.tellg();
+
+    if (start != std::istream::pos_type(-1) && stream.seekg(0, std::ios::end))
+    {
+        auto end = stream.tellg();
+
+        if (stream.seekg(start) && end - start > 0)
+        {
+            buffer.reserve(static_cast<std::size_t>(end - start));
+        }
+    }
+
+    // a stream that can't seek, like a pipe, fails the attempt but can still be read
+    stream.clear();
+
+    while (true)
+    {
+        if (buffer.size() == buffer.capacity())
+        {
+            if (std::istream::traits_type::eq_int_type(stream.peek(), std::istream::traits_type::eof()))
+            {
+                break;
+            }
+
+            buffer.reserve(std::max(first_block_size, buffer.capacity() * 2));
+        }
+
+        auto size = buffer.size();
+        buffer.resize(buffer.capacity());
+        stream.read(buffer.data() + size, static_cast<std::streamsize>(buffer.size() - size));
+        buffer.resize(size + static_cast<std::size_t>(stream.gcount()));
+
+        if (!stream)
+        {
+            break;
+        }
+    }
+}
+
+/// <summary>
+/// Return the name of a member as it's looked up by name. miniz compares names
+/// without regard to ASCII case so they're indexed the same way.
+/// </summary>
+std::string member_key(const std::string &name)
+{
+    auto key = name;
+
+    for (auto &c : key)
+    {
+        if (c >= 'A' && c <= 'Z')
+        {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+
+    return key;
+}
+
+/// <summary>
+/// Describe the member of an archive being read which stat was filled in for.
+/// </summary>
+xlnt::zip_info to_zip_info(const mz_zip_archive_file_stat &stat)
+{
+    xlnt::zip_info result;
+
+    result.filename = std::string(stat.m_filename, stat.m_filename + std::strlen(stat.m_filename));
+    result.comment = std::string(stat.m_comment, stat.m_comment + stat.m_comment_size);
+    result.compress_size = static_cast<std::size_t>(stat.m_comp_size);
+    result.file_size = static_cast<std::size_t>(stat.m_uncomp_size);
+    result.header_offset = static_cast<std::size_t>(stat.m_local_header_ofs);
+    result.crc = stat.m_crc32;
+    auto time = safe_localtime(stat.m_time);
+    result.date_time.year = 1900 + time.tm_year;
+    result.date_time.month = 1 + time.tm_mon;
+    result.date_time.day = time.tm_mday;
+    result.date_time.hours = time.tm_hour;
+    result.date_time.minutes = time.tm_min;
+    result.date_time.seconds = time.tm_sec;
+    result.flag_bits = stat.m_bit_flag;
+    result.internal_attr = stat.m_internal_attr;
+    result.external_attr = stat.m_external_attr;
+    result.extract_version = stat.m_version_needed;
+    result.create_version = stat.m_version_made_by;
+    result.volume = stat.m_file_index;
+    result.create_system = stat.m_method;
+
+    return result;
+}
+
+template <typename Buffer>
 std::size_t write_callback(void *opaque, mz_uint64 file_ofs, const void *pBuf, std::size_t n)
 {
-    auto buffer = static_cast<std::vector<char> *>(opaque);
+    auto buffer = static_cast<Buffer *>(opaque);
+    auto end = static_cast<std::size_t>(file_ofs) + n;
 
-    if (file_ofs + n > buffer->size())
+    if (end > buffer->size())
     {
-        auto new_size = static_cast<std::vector<char>::size_type>(file_ofs + n);
-        buffer->resize(new_size);
+        // miniz writes a few bytes at a time so grow geometrically rather than to fit
+        if (end > buffer->capacity())
+        {
+            buffer->reserve(std::max(end, buffer->capacity() * 2));
+        }
+
+        buffer->resize(end);
     }
 
-    for (std::size_t i = 0; i < n; i++)
+    if (n != 0)
     {
-        (*buffer)[static_cast<std::size_t>(file_ofs + i)] = (static_cast<const char *>(pBuf))[i];
+        std::memcpy(&(*buffer)[static_cast<std::size_t>(file_ofs)], pBuf, n);
     }
 
     return n;
 }
 
+/// <summary>
+/// A read-only streambuf over one member of an in-memory archive. Deflated
+/// members are inflated a window at a time as the get area is exhausted,
+/// stored members are exposed in place.
+/// </summary>
+class inflate_streambuf : public std::streambuf
+{
+public:
+    inflate_streambuf(const char *data, std::size_t size, bool deflated) : deflated_(deflated)
+    {
+        if (!deflated_)
+        {
+            auto begin = const_cast<char *>(data);
+            setg(begin, begin, begin + size);
+
+            return;
+        }
+
+        std::memset(&stream_, 0, sizeof(stream_));
+        stream_.next_in = reinterpret_cast<const unsigned char *>(data);
+        stream_.avail_in = static_cast<unsigned int>(size);
+
+        if (mz_inflateInit2(&stream_, -MZ_DEFAULT_WINDOW_BITS) != MZ_OK)
+        {
+            throw std::runtime_error("couldn't initialize inflate");
+        }
+
+        buffer_.resize(32768);
+    }
+
+    ~inflate_streambuf()
+    {
+        if (deflated_)
+        {
+            mz_inflateEnd(&stream_);
+        }
+    }
+
+protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        if (!deflated_ || finished_)
+        {
+            return traits_type::eof();
+        }
+
+        stream_.next_out = reinterpret_cast<unsigned char *>(buffer_.data());
+        stream_.avail_out = static_cast<unsigned int>(buffer_.size());
+
+        auto status = mz_inflate(&stream_, MZ_NO_FLUSH);
+
+        if (status == MZ_STREAM_END)
+        {
+            finished_ = true;
+        }
+        else if (status != MZ_OK)
+        {
+            throw std::runtime_error("couldn't inflate zip member");
+        }
+
+        auto produced = buffer_.size() - stream_.avail_out;
+
+        if (produced == 0)
+        {
+            return traits_type::eof();
+        }
+
+        setg(buffer_.data(), buffer_.data(), buffer_.data() + produced);
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    bool deflated_;
+    bool finished_ = false;
+    mz_stream stream_;
+    std::vector<char> buffer_;
+};
+
+class inflate_istream : public std::istream
+{
+public:
+    inflate_istream(const char *data, std::size_t size, bool deflated)
+        : std::istream(nullptr),
+          buffer_(data, size, deflated)
+    {
+        rdbuf(&buffer_);
+    }
+
+private:
+    inflate_streambuf buffer_;
+};
+
 } // namespace
 
 namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A write-only streambuf which deflates its put area into a growing buffer
+/// each time it fills up. At compression_level::store the put area is copied
+/// into the buffer as it is.
+/// </summary>
+class deflate_streambuf : public std::streambuf
+{
+public:
+    deflate_streambuf(compression_level level) : level_(level), buffer_(32768)
+    {
+        std::memset(&stream_, 0, sizeof(stream_));
+
+        auto miniz_level = static_cast<int>(to_miniz_level(level));
+
+        if (level != compression_level::store
+            && mz_deflateInit2(&stream_, miniz_level, MZ_DEFLATED, -MZ_DEFAULT_WINDOW_BITS, 9, MZ_DEFAULT_STRATEGY) != MZ_OK)
+        {
+            throw std::runtime_error("couldn't initialize deflate");
+        }
+
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    ~deflate_streambuf()
+    {
+        mz_deflateEnd(&stream_);
+    }
+
+    void finish()
+    {
+        if (finished_)
+        {
+            return;
+        }
+
+        compress(MZ_FINISH);
+        finished_ = true;
+        setp(nullptr, nullptr);
+    }
+
+    const compression_level level_;
+    bool finished_ = false;
+    std::uint32_t crc_ = MZ_CRC32_INIT;
+    std::size_t uncompressed_size_ = 0;
+    std::vector<char> compressed_;
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (finished_)
+        {
+            return traits_type::eof();
+        }
+
+        compress(MZ_NO_FLUSH);
+
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+private:
+    void compress(int flush)
+    {
+        auto pending = reinterpret_cast<const unsigned char *>(pbase());
+        auto pending_size = static_cast<std::size_t>(pptr() - pbase());
+
+        crc_ = compute_crc32(crc_, pending, pending_size);
+        uncompressed_size_ += pending_size;
+
+        if (level_ == compression_level::store)
+        {
+            compressed_.insert(compressed_.end(), pbase(), pptr());
+            setp(buffer_.data(), buffer_.data() + buffer_.size());
+
+            return;
+        }
+
+        stream_.next_in = pending;
+        stream_.avail_in = static_cast<unsigned int>(pending_size);
+
+        while (true)
+        {
+            auto offset = compressed_.size();
+            compressed_.resize(offset + 16384);
+
+            stream_.next_out = reinterpret_cast<unsigned char *>(compressed_.data() + offset);
+            stream_.avail_out = 16384;
+
+            auto status = mz_deflate(&stream_, flush);
+            compressed_.resize(compressed_.size() - stream_.avail_out);
+
+            if (status == MZ_STREAM_END)
+            {
+                break;
+            }
+
+            if (status != MZ_OK && status != MZ_BUF_ERROR)
+            {
+                throw std::runtime_error("couldn't deflate zip member");
+            }
+
+            if (flush == MZ_NO_FLUSH && stream_.avail_in == 0 && stream_.avail_out != 0)
+            {
+                break;
+            }
+        }
+
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    mz_stream stream_;
+    std::vector<char> buffer_;
+};
+
+/// <summary>
+/// The destination of an archive started with zip_file::begin_save.
+/// </summary>
+struct zip_sink
+{
+    std::ostream *stream = nullptr;
+    std::ostream::pos_type start;
+    std::uint64_t position = 0;
+    std::vector<unsigned char> *bytes = nullptr;
+
+    static std::size_t write_stream(void *opaque, mz_uint64 file_ofs, const void *pBuf, std::size_t n)
+    {
+        auto sink = static_cast<zip_sink *>(opaque);
+
+        // miniz only goes back to fill in the local header of the member just written
+        if (file_ofs != sink->position)
+        {
+            sink->stream->seekp(sink->start + static_cast<std::streamoff>(file_ofs));
+        }
+
+        sink->stream->write(static_cast<const char *>(pBuf), static_cast<std::streamsize>(n));
+        sink->position = file_ofs + n;
+
+        return sink->stream->good() ? n : 0;
+    }
+};
+
+/// <summary>
+/// A member added to an archive while parallel compression is enabled. Members
+/// which aren't deflated, because they're stored or too small, are done as
+/// soon as they're queued.
+/// </summary>
+struct pending_member
+{
+    std::string arcname;
+    std::string bytes;
+    compression_level level;
+    bool deflated = false;
+    bool done = false;
+    std::vector<char> compressed;
+    std::size_t uncompressed_size = 0;
+    std::uint32_t crc = 0;
+    std::exception_ptr error;
+};
+
+/// <summary>
+/// Deflates members on a pool of threads. Members are handed back by next in
+/// the order they were queued regardless of which finishes first so that the
+/// archive is laid out exactly as it would be if they were added one by one.
+/// </summary>
+class deflate_pool
+{
+public:
+    deflate_pool() : stop_(false)
+    {
+        auto thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned int i = 0; i < thread_count; i++)
+        {
+            threads_.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~deflate_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            waiting_.clear();
+        }
+
+        work_available_.notify_all();
+
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    void push(std::unique_ptr<pending_member> member)
+    {
+        // miniz stores members this small rather than deflating them
+        member->deflated = member->level != compression_level::store && member->bytes.size() > 3;
+        member->done = !member->deflated;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (member->deflated)
+            {
+                waiting_.push_back(member.get());
+            }
+
+            queued_.push_back(std::move(member));
+        }
+
+        work_available_.notify_one();
+    }
+
+    /// <summary>
+    /// Return the oldest queued member once it's done, waiting for it if wait is
+    /// true. Returns nullptr if there's nothing to return.
+    /// </summary>
+    std::unique_ptr<pending_member> next(bool wait)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (queued_.empty())
+        {
+            return nullptr;
+        }
+
+        if (wait)
+        {
+            member_done_.wait(lock, [this]() { return queued_.front()->done; });
+        }
+        else if (!queued_.front()->done)
+        {
+            return nullptr;
+        }
+
+        auto member = std::move(queued_.front());
+        queued_.pop_front();
+
+        return member;
+    }
+
+private:
+    void work()
+    {
+        while (true)
+        {
+            pending_member *member = nullptr;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_available_.wait(lock, [this]() { return stop_ || !waiting_.empty(); });
+
+                if (stop_)
+                {
+                    return;
+                }
+
+                member = waiting_.front();
+                waiting_.pop_front();
+            }
+
+            try
+            {
+                deflate(*member);
+            }
+            catch (...)
+            {
+                member->error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                member->done = true;
+            }
+
+            member_done_.notify_all();
+        }
+    }
+
+    static void deflate(pending_member &member)
+    {
+        member.uncompressed_size = member.bytes.size();
+        member.crc = compute_crc32(0, member.bytes.data(), member.bytes.size());
+        member.compressed.reserve(member.bytes.size() / 4);
+        deflate_bytes(member.bytes.data(), member.bytes.size(), member.level, member.compressed);
+
+        // the uncompressed bytes aren't needed anymore
+        std::string().swap(member.bytes);
+    }
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable member_done_;
+    std::deque<std::unique_ptr<pending_member>> queued_;
+    std::deque<pending_member *> waiting_;
+    std::vector<std::thread> threads_;
+    bool stop_;
+};
+
+} // namespace detail
+
+deflate_ostream::deflate_ostream() : deflate_ostream(compression_level::best)
+{
+}
+
+deflate_ostream::deflate_ostream(compression_level level)
+    : std::ostream(nullptr),
+      buffer_(new detail::deflate_streambuf(level))
+{
+    rdbuf(buffer_.get());
+}
+
+deflate_ostream::~deflate_ostream()
+{
+}
+
+void deflate_ostream::finish()
+{
+    buffer_->finish();
+}
+
+bool deflate_ostream::is_finished() const
+{
+    return buffer_->finished_;
+}
+
+std::uint32_t deflate_ostream::get_crc() const
+{
+    return buffer_->crc_;
+}
+
+std::size_t deflate_ostream::get_uncompressed_size() const
+{
+    return buffer_->uncompressed_size_;
+}
+
+compression_level deflate_ostream::get_compression_level() const
+{
+    return buffer_->level_;
+}
+
+const std::vector<char> &deflate_ostream::get_compressed() const
+{
+    return buffer_->compressed_;
+}
 
 zip_info::zip_info()
     : create_system(0),
@@ -244,7 +839,11 @@ zip_info::zip_info()
     date_time.seconds = 0;
 }
 
-zip_file::zip_file() : archive_(new mz_zip_archive())
+zip_file::zip_file()
+    : archive_(new mz_zip_archive()),
+      mapped_(new detail::mapped_file()),
+      compression_level_(compression_level::best),
+      parallel_compression_(false)
 {
     reset();
 }
@@ -272,7 +871,7 @@ zip_file::~zip_file()
 void zip_file::load(std::istream &stream)
 {
     reset();
-    buffer_.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    read_all(stream, buffer_);
     remove_comment();
     start_read();
 }
@@ -280,8 +879,23 @@ void zip_file::load(std::istream &stream)
 void zip_file::load(const std::string &filename)
 {
     filename_ = filename;
-    std::ifstream stream(filename, std::ios::binary);
-    load(stream);
+    reset();
+
+    if (!mapped_->open(filename))
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        load(stream);
+
+        return;
+    }
+
+    // the comment is left in place since the mapping is read-only, miniz finds
+    // the central directory regardless
+    std::uint16_t comment_length = 0;
+    auto comment_offset = find_comment(mapped_->data(), mapped_->size(), comment_length);
+    comment.assign(mapped_->data() + comment_offset, std::min<std::size_t>(comment_length, mapped_->size() - comment_offset));
+
+    start_read();
 }
 
 void zip_file::load(const std::vector<unsigned char> &bytes)
@@ -294,6 +908,9 @@ void zip_file::load(const std::vector<unsigned char> &bytes)
 
 void zip_file::save(const std::string &filename)
 {
+    // the file being written might be the one that's mapped
+    release_file();
+
     filename_ = filename;
     std::ofstream stream(filename, std::ios::binary);
     save(stream);
@@ -301,8 +918,18 @@ void zip_file::save(const std::string &filename)
 
 void zip_file::save(std::ostream &stream)
 {
+    write_pending(true);
+
+    if (end_save(&stream))
+    {
+        return;
+    }
+
+    release_file();
+
     if (archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
     {
+        copy_unmodified();
         mz_zip_writer_finalize_archive(archive_.get());
     }
 
@@ -322,8 +949,18 @@ void zip_file::save(std::ostream &stream)
 
 void zip_file::save(std::vector<unsigned char> &bytes)
 {
+    write_pending(true);
+
+    if (end_save(&bytes))
+    {
+        return;
+    }
+
+    release_file();
+
     if (archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
     {
+        copy_unmodified();
         mz_zip_writer_finalize_archive(archive_.get());
     }
 
@@ -341,6 +978,93 @@ void zip_file::save(std::vector<unsigned char> &bytes)
     bytes.assign(buffer_.begin(), buffer_.end());
 }
 
+void zip_file::begin_save(std::ostream &stream)
+{
+    reset();
+
+    auto start = stream.tellp();
+
+    if (start == std::ostream::pos_type(-1))
+    {
+        return;
+    }
+
+    sink_.reset(new detail::zip_sink());
+    sink_->stream = &stream;
+    sink_->start = start;
+
+    archive_->m_pWrite = &detail::zip_sink::write_stream;
+    archive_->m_pIO_opaque = sink_.get();
+
+    if (!mz_zip_writer_init(archive_.get(), 0))
+    {
+        sink_.reset();
+        throw std::runtime_error("bad zip");
+    }
+}
+
+void zip_file::begin_save(std::vector<unsigned char> &bytes)
+{
+    reset();
+
+    bytes.clear();
+    sink_.reset(new detail::zip_sink());
+    sink_->bytes = &bytes;
+
+    archive_->m_pWrite = &write_callback<std::vector<unsigned char>>;
+    archive_->m_pIO_opaque = &bytes;
+
+    if (!mz_zip_writer_init(archive_.get(), 0))
+    {
+        sink_.reset();
+        throw std::runtime_error("bad zip");
+    }
+}
+
+bool zip_file::end_save(const void *destination)
+{
+    if (!sink_)
+    {
+        return false;
+    }
+
+    if (destination != sink_->stream && destination != sink_->bytes)
+    {
+        throw std::runtime_error("archive is being saved somewhere else");
+    }
+
+    if (!mz_zip_writer_finalize_archive(archive_.get()))
+    {
+        throw std::runtime_error("couldn't finish archive");
+    }
+
+    auto size = static_cast<std::size_t>(archive_->m_archive_size);
+    mz_zip_writer_end(archive_.get());
+
+    auto comment_length = std::min(comment.length(), static_cast<std::size_t>(std::numeric_limits<uint16_t>::max()));
+    const char length_bytes[2] = { static_cast<char>(comment_length), static_cast<char>(comment_length >> 8) };
+
+    if (sink_->bytes != nullptr)
+    {
+        auto &bytes = *sink_->bytes;
+        bytes.resize(size);
+        bytes[size - 2] = static_cast<unsigned char>(length_bytes[0]);
+        bytes[size - 1] = static_cast<unsigned char>(length_bytes[1]);
+        bytes.insert(bytes.end(), comment.begin(), comment.begin() + static_cast<std::ptrdiff_t>(comment_length));
+    }
+    else
+    {
+        auto &stream = *sink_->stream;
+        stream.seekp(sink_->start + static_cast<std::streamoff>(size - 2));
+        stream.write(length_bytes, 2);
+        stream.write(comment.data(), static_cast<std::streamsize>(comment_length));
+    }
+
+    sink_.reset();
+
+    return true;
+}
+
 void zip_file::append_comment()
 {
     if (!comment.empty())
@@ -356,38 +1080,87 @@ void zip_file::remove_comment()
 {
     if (buffer_.empty()) return;
 
-    std::size_t position = buffer_.size() - 1;
+    uint16_t length = 0;
+    auto position = find_comment(buffer_.data(), buffer_.size(), length);
 
-    for (; position >= 3; position--)
+    if (length != 0)
     {
-        if (buffer_[position - 3] == 'P' && buffer_[position - 2] == 'K' && buffer_[position - 1] == '\x05' &&
-            buffer_[position] == '\x06')
+        comment = std::string(buffer_.data() + position, buffer_.data() + position + length);
+        buffer_.resize(buffer_.size() - length);
+        buffer_[buffer_.size() - 1] = 0;
+        buffer_[buffer_.size() - 2] = 0;
+    }
+}
+
+bool zip_file::is_mapped_from(const std::string &filename) const
+{
+    return mapped_->is_same_file(filename);
+}
+
+void zip_file::release_file()
+{
+    if (!mapped_->is_open()) return;
+
+    if (source_)
+    {
+        // members which haven't been replaced are still to be copied from the mapping
+        mz_zip_reader_end(source_.get());
+        source_buffer_.assign(mapped_->data(), mapped_->data() + mapped_->size());
+        mapped_->close();
+
+        if (!mz_zip_reader_init_mem(source_.get(), source_buffer_.data(), source_buffer_.size(), 0))
         {
-            position = position + 17;
-            break;
+            close_source();
+            throw std::runtime_error("bad zip");
         }
+
+        return;
     }
 
-    if (position <= 3)
+    auto reading = archive_->m_zip_mode == MZ_ZIP_MODE_READING;
+
+    if (reading)
     {
-        throw std::runtime_error("didn't find end of central directory signature");
+        mz_zip_reader_end(archive_.get());
     }
 
-    uint16_t length = static_cast<uint16_t>(buffer_[position + 1]);
-    length = static_cast<uint16_t>(length << 8) + static_cast<uint16_t>(buffer_[position]);
-    position += 2;
+    buffer_.assign(mapped_->data(), mapped_->data() + mapped_->size());
+    mapped_->close();
 
-    if (length != 0)
+    // the comment may have been changed since the archive was loaded
+    auto current_comment = comment;
+    remove_comment();
+    comment = current_comment;
+
+    if (reading)
     {
-        comment = std::string(buffer_.data() + position, buffer_.data() + position + length);
-        buffer_.resize(buffer_.size() - length);
-        buffer_[buffer_.size() - 1] = 0;
-        buffer_[buffer_.size() - 2] = 0;
+        start_read();
     }
 }
 
+const char *zip_file::get_data() const
+{
+    return mapped_->is_open() ? mapped_->data() : buffer_.data();
+}
+
+std::size_t zip_file::get_size() const
+{
+    return mapped_->is_open() ? mapped_->size() : buffer_.size();
+}
+
 void zip_file::reset()
 {
+    // members still being deflated are discarded along with the rest of the archive
+    deflate_pool_.reset();
+    close_source();
+
+    if (sink_)
+    {
+        // the destination might not exist anymore so the archive is abandoned rather than finished
+        mz_zip_writer_end(archive_.get());
+        sink_.reset();
+    }
+
     switch (archive_->m_zip_mode)
     {
     case MZ_ZIP_MODE_READING:
@@ -402,7 +1175,10 @@ void zip_file::reset()
     }
 
     buffer_.clear();
+    mapped_->close();
     comment.clear();
+    members_.clear();
+    member_indices_.clear();
 
     start_write();
     mz_zip_writer_finalize_archive(archive_.get());
@@ -416,58 +1192,30 @@ zip_info zip_file::getinfo(const std::string &name)
         start_read();
     }
 
-    int index = mz_zip_reader_locate_file(archive_.get(), name.c_str(), nullptr, 0);
-
-    if (index == -1)
-    {
-        throw std::runtime_error("not found");
-    }
-
-    return getinfo(index);
-}
+    int index = find_member(name);
 
-zip_info zip_file::getinfo(int index)
-{
-    if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
-    {
-        start_read();
-    }
-
-    mz_zip_archive_file_stat stat;
-    mz_zip_reader_file_stat(archive_.get(), static_cast<mz_uint>(index), &stat);
-
-    zip_info result;
-
-    result.filename = std::string(stat.m_filename, stat.m_filename + std::strlen(stat.m_filename));
-    result.comment = std::string(stat.m_comment, stat.m_comment + stat.m_comment_size);
-    result.compress_size = static_cast<std::size_t>(stat.m_comp_size);
-    result.file_size = static_cast<std::size_t>(stat.m_uncomp_size);
-    result.header_offset = static_cast<std::size_t>(stat.m_local_header_ofs);
-    result.crc = stat.m_crc32;
-    auto time = safe_localtime(stat.m_time);
-    result.date_time.year = 1900 + time.tm_year;
-    result.date_time.month = 1 + time.tm_mon;
-    result.date_time.day = time.tm_mday;
-    result.date_time.hours = time.tm_hour;
-    result.date_time.minutes = time.tm_min;
-    result.date_time.seconds = time.tm_sec;
-    result.flag_bits = stat.m_bit_flag;
-    result.internal_attr = stat.m_internal_attr;
-    result.external_attr = stat.m_external_attr;
-    result.extract_version = stat.m_version_needed;
-    result.create_version = stat.m_version_made_by;
-    result.volume = stat.m_file_index;
-    result.create_system = stat.m_method;
+    if (index == -1)
+    {
+        throw std::runtime_error("not found");
+    }
 
-    return result;
+    return members_[static_cast<std::size_t>(index)];
 }
 
 void zip_file::start_read()
 {
     if (archive_->m_zip_mode == MZ_ZIP_MODE_READING) return;
 
+    if (sink_)
+    {
+        throw std::runtime_error("members of an archive being saved can't be read");
+    }
+
+    write_pending(true);
+
     if (archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
     {
+        copy_unmodified();
         mz_zip_writer_finalize_archive(archive_.get());
     }
 
@@ -476,10 +1224,49 @@ void zip_file::start_read()
         mz_zip_writer_end(archive_.get());
     }
 
-    if (!mz_zip_reader_init_mem(archive_.get(), buffer_.data(), buffer_.size(), 0))
+    if (!mz_zip_reader_init_mem(archive_.get(), get_data(), get_size(), 0))
     {
         throw std::runtime_error("bad zip");
     }
+
+    index_members();
+}
+
+void zip_file::index_members()
+{
+    members_.clear();
+    member_indices_.clear();
+
+    auto member_count = static_cast<std::size_t>(mz_zip_reader_get_num_files(archive_.get()));
+    members_.reserve(member_count);
+    member_indices_.reserve(member_count);
+
+    for (std::size_t i = 0; i < member_count; i++)
+    {
+        mz_zip_archive_file_stat stat;
+
+        if (!mz_zip_reader_file_stat(archive_.get(), static_cast<mz_uint>(i), &stat))
+        {
+            throw std::runtime_error("bad zip");
+        }
+
+        members_.push_back(to_zip_info(stat));
+
+        // the first of several members with the same name wins
+        member_indices_.emplace(member_key(members_.back().filename), i);
+    }
+}
+
+int zip_file::find_member(const std::string &name)
+{
+    if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
+    {
+        start_read();
+    }
+
+    auto match = member_indices_.find(member_key(name));
+
+    return match == member_indices_.end() ? -1 : static_cast<int>(match->second);
 }
 
 void zip_file::start_write()
@@ -490,18 +1277,33 @@ void zip_file::start_write()
     {
     case MZ_ZIP_MODE_READING:
     {
-        mz_zip_archive archive_copy;
-        std::memset(&archive_copy, 0, sizeof(mz_zip_archive));
-        std::vector<char> buffer_copy(buffer_.begin(), buffer_.end());
+        mz_zip_reader_end(archive_.get());
+        members_.clear();
+
+        // members of the loaded archive are still looked up by name as they are written again
+        source_indices_ = std::move(member_indices_);
+        member_indices_.clear();
+
+        // the loaded archive is left alone until it's saved, a mapped one is read
+        // from where it is and one in memory is moved aside rather than copied
+        if (!mapped_->is_open())
+        {
+            source_buffer_ = std::move(buffer_);
+        }
+
+        source_.reset(new mz_zip_archive());
+        auto source_data = mapped_->is_open() ? mapped_->data() : source_buffer_.data();
+        auto source_size = mapped_->is_open() ? mapped_->size() : source_buffer_.size();
 
-        if (!mz_zip_reader_init_mem(&archive_copy, buffer_copy.data(), buffer_copy.size(), 0))
+        if (!mz_zip_reader_init_mem(source_.get(), source_data, source_size, 0))
         {
+            close_source();
             throw std::runtime_error("bad zip");
         }
 
-        mz_zip_reader_end(archive_.get());
+        replaced_.assign(source_->m_total_files, false);
 
-        archive_->m_pWrite = &write_callback;
+        archive_->m_pWrite = &write_callback<std::vector<char>>;
         archive_->m_pIO_opaque = &buffer_;
         buffer_ = std::vector<char>();
 
@@ -510,22 +1312,13 @@ void zip_file::start_write()
             throw std::runtime_error("bad zip");
         }
 
-        for (unsigned int i = 0; i < static_cast<unsigned int>(archive_copy.m_total_files); i++)
-        {
-            if (!mz_zip_writer_add_from_zip_reader(archive_.get(), &archive_copy, i))
-            {
-                throw std::runtime_error("fail");
-            }
-        }
-
-        mz_zip_reader_end(&archive_copy);
         return;
     }
     default:
         break;
     }
 
-    archive_->m_pWrite = &write_callback;
+    archive_->m_pWrite = &write_callback<std::vector<char>>;
     archive_->m_pIO_opaque = &buffer_;
 
     mz_zip_writer_init(archive_.get(), 0);
@@ -554,12 +1347,20 @@ void zip_file::write(const std::string &filename, const std::string &arcname)
 
 void zip_file::writestr(const std::string &arcname, const std::string &bytes)
 {
+    if (parallel_compression_)
+    {
+        writestr(arcname, std::string(bytes));
+        return;
+    }
+
     if (archive_->m_zip_mode != MZ_ZIP_MODE_WRITING)
     {
         start_write();
     }
 
-    mz_zip_writer_add_mem(archive_.get(), arcname.c_str(), bytes.data(), bytes.size(), MZ_BEST_COMPRESSION);
+    write_pending(true);
+    replace_member(arcname);
+    add_member(arcname, bytes, "");
 }
 
 void zip_file::writestr(const zip_info &info, const std::string &bytes)
@@ -574,24 +1375,279 @@ void zip_file::writestr(const zip_info &info, const std::string &bytes)
         start_write();
     }
 
-    auto crc = crc32buf(bytes.c_str(), bytes.size());
+    write_pending(true);
+    replace_member(info.filename);
+    add_member(info.filename, bytes, info.comment);
+}
+
+void zip_file::writestr(const std::string &arcname, std::string &&bytes)
+{
+    if (!parallel_compression_)
+    {
+        writestr(arcname, static_cast<const std::string &>(bytes));
+        return;
+    }
+
+    if (archive_->m_zip_mode != MZ_ZIP_MODE_WRITING)
+    {
+        start_write();
+    }
+
+    if (!deflate_pool_)
+    {
+        deflate_pool_.reset(new detail::deflate_pool());
+    }
+
+    replace_member(arcname);
+
+    std::unique_ptr<detail::pending_member> member(new detail::pending_member());
+    member->arcname = arcname;
+    member->bytes = std::move(bytes);
+    member->level = get_compression_level(arcname);
+    deflate_pool_->push(std::move(member));
+
+    // add whatever has finished so far so compressed members don't pile up
+    write_pending(false);
+}
+
+void zip_file::write_pending(bool wait)
+{
+    if (!deflate_pool_) return;
+
+    while (auto member = deflate_pool_->next(wait))
+    {
+        if (member->error)
+        {
+            std::rethrow_exception(member->error);
+        }
+
+        auto added = member->deflated
+            ? mz_zip_writer_add_mem_ex(archive_.get(), member->arcname.c_str(), member->compressed.data(),
+                member->compressed.size(), nullptr, 0, to_miniz_level(member->level) | MZ_ZIP_FLAG_COMPRESSED_DATA,
+                member->uncompressed_size, member->crc)
+            : mz_zip_writer_add_mem(archive_.get(), member->arcname.c_str(), member->bytes.data(),
+                member->bytes.size(), to_miniz_level(member->level));
+
+        if (!added)
+        {
+            throw std::runtime_error("couldn't add " + member->arcname + " to archive");
+        }
+    }
+}
+
+void zip_file::add_member(const std::string &arcname, const std::string &bytes, const std::string &comment)
+{
+    auto level = get_compression_level(arcname);
+    mz_bool added = MZ_FALSE;
+
+    // miniz stores members this small rather than deflating them
+    if (level == compression_level::store || bytes.size() <= 3)
+    {
+        added = mz_zip_writer_add_mem_ex(archive_.get(), arcname.c_str(), bytes.data(), bytes.size(),
+            comment.c_str(), static_cast<mz_uint16>(comment.size()), to_miniz_level(level), 0, 0);
+    }
+    else
+    {
+        std::vector<char> compressed;
+        compressed.reserve(bytes.size() / 4);
+        detail::deflate_bytes(bytes.data(), bytes.size(), level, compressed);
+
+        added = mz_zip_writer_add_mem_ex(archive_.get(), arcname.c_str(), compressed.data(), compressed.size(),
+            comment.c_str(), static_cast<mz_uint16>(comment.size()), to_miniz_level(level) | MZ_ZIP_FLAG_COMPRESSED_DATA,
+            bytes.size(), detail::compute_crc32(0, bytes.data(), bytes.size()));
+    }
+
+    if (!added)
+    {
+        throw std::runtime_error("couldn't add " + arcname + " to archive");
+    }
+}
+
+void zip_file::replace_member(const std::string &arcname)
+{
+    if (!source_) return;
+
+    auto match = source_indices_.find(member_key(arcname));
+
+    if (match != source_indices_.end())
+    {
+        replaced_[match->second] = true;
+    }
+}
+
+void zip_file::copy_unmodified()
+{
+    if (!source_) return;
+
+    write_pending(true);
+
+    // the compressed data is copied as it is, nothing is inflated or deflated again
+    for (mz_uint i = 0; i < source_->m_total_files; i++)
+    {
+        if (!replaced_[i] && !mz_zip_writer_add_from_zip_reader(archive_.get(), source_.get(), i))
+        {
+            throw std::runtime_error("couldn't copy member of loaded archive");
+        }
+    }
+
+    close_source();
+}
+
+void zip_file::close_source()
+{
+    if (!source_) return;
+
+    mz_zip_reader_end(source_.get());
+    source_.reset();
+    source_buffer_ = std::vector<char>();
+    source_indices_.clear();
+    replaced_.clear();
+    mapped_->close();
+}
+
+void zip_file::writestr(const std::string &arcname, deflate_ostream &stream)
+{
+    if (archive_->m_zip_mode != MZ_ZIP_MODE_WRITING)
+    {
+        start_write();
+    }
+
+    write_pending(true);
+    replace_member(arcname);
+
+    stream.finish();
+    const auto &compressed = stream.get_compressed();
+
+    // stored members have to be added as they are since miniz marks anything added
+    // with MZ_ZIP_FLAG_COMPRESSED_DATA as deflated
+    auto stored = stream.get_compression_level() == compression_level::store;
+    auto level_and_flags = stored ? to_miniz_level(compression_level::store)
+                                  : to_miniz_level(stream.get_compression_level()) | MZ_ZIP_FLAG_COMPRESSED_DATA;
+
+    if (!mz_zip_writer_add_mem_ex(archive_.get(), arcname.c_str(), compressed.data(), compressed.size(), nullptr, 0,
+        level_and_flags, stored ? 0 : stream.get_uncompressed_size(), stored ? 0 : stream.get_crc()))
+    {
+        throw std::runtime_error("couldn't add " + arcname + " to archive");
+    }
+}
+
+void zip_file::copy_member(zip_file &source, const std::string &arcname)
+{
+    if (&source == this)
+    {
+        throw std::runtime_error("can't copy a member of an archive into itself");
+    }
+
+    source.start_read();
+
+    auto index = source.find_member(arcname);
+
+    if (index == -1)
+    {
+        throw std::runtime_error("not found");
+    }
+
+    if (archive_->m_zip_mode != MZ_ZIP_MODE_WRITING)
+    {
+        start_write();
+    }
+
+    write_pending(true);
+    replace_member(arcname);
+
+    if (!mz_zip_writer_add_from_zip_reader(archive_.get(), source.archive_.get(), static_cast<mz_uint>(index)))
+    {
+        throw std::runtime_error("couldn't copy " + arcname + " to archive");
+    }
+}
+
+compression_level zip_file::get_compression_level() const
+{
+    return compression_level_;
+}
+
+void zip_file::set_compression_level(compression_level level)
+{
+    compression_level_ = level;
+}
+
+compression_level zip_file::get_compression_level(const std::string &arcname) const
+{
+    auto match = member_compression_levels_.find(arcname);
+    return match == member_compression_levels_.end() ? compression_level_ : match->second;
+}
+
+void zip_file::set_compression_level(const std::string &arcname, compression_level level)
+{
+    member_compression_levels_[arcname] = level;
+}
+
+bool zip_file::get_parallel_compression() const
+{
+    return parallel_compression_;
+}
 
-    mz_zip_writer_add_mem_ex(archive_.get(), info.filename.c_str(), bytes.data(), bytes.size(),
-        info.comment.c_str(), static_cast<mz_uint16>(info.comment.size()),
-        MZ_BEST_COMPRESSION, 0, crc);
+void zip_file::set_parallel_compression(bool parallel_compression)
+{
+    parallel_compression_ = parallel_compression;
 }
 
 std::string zip_file::read(const zip_info &info)
 {
-    std::size_t size;
-    char *data =
-        static_cast<char *>(mz_zip_reader_extract_file_to_heap(archive_.get(), info.filename.c_str(), &size, 0));
-    if (data == nullptr)
+    if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
+    {
+        start_read();
+    }
+
+    int index = find_member(info.filename);
+
+    if (index == -1)
+    {
+        throw std::runtime_error("file couldn't be read");
+    }
+
+    mz_zip_archive_file_stat stat;
+
+    if (!mz_zip_reader_file_stat(archive_.get(), static_cast<mz_uint>(index), &stat))
+    {
+        throw std::runtime_error("file couldn't be read");
+    }
+
+    if ((stat.m_method != 0 && stat.m_method != MZ_DEFLATED) || (stat.m_bit_flag & 1))
+    {
+        throw std::runtime_error("unsupported compression method");
+    }
+
+    auto data = find_member_data(get_data(), get_size(), stat);
+    auto data_size = static_cast<std::size_t>(stat.m_comp_size);
+
+    std::string extracted;
+
+    if (stat.m_method == 0)
+    {
+        if (data_size != stat.m_uncomp_size)
+        {
+            throw std::runtime_error("file couldn't be read");
+        }
+
+        extracted.assign(data, data_size);
+    }
+    else
+    {
+        // inflate straight into the result rather than into a heap block which then has to be copied
+        extracted.resize(static_cast<std::size_t>(stat.m_uncomp_size));
+
+        if (!extracted.empty() && !detail::inflate_bytes(data, data_size, &extracted[0], extracted.size()))
+        {
+            throw std::runtime_error("file couldn't be read");
+        }
+    }
+
+    if (detail::compute_crc32(0, extracted.data(), extracted.size()) != stat.m_crc32)
     {
         throw std::runtime_error("file couldn't be read");
     }
-    std::string extracted(data, data + size);
-    mz_free(data);
+
     return extracted;
 }
 
@@ -600,38 +1656,113 @@ std::string zip_file::read(const std::string &name)
     return read(getinfo(name));
 }
 
-bool zip_file::has_file(const std::string &name)
+void zip_file::read(const zip_info &info, const std::function<void(const char *, std::size_t)> &callback)
 {
     if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
     {
         start_read();
     }
 
-    int index = mz_zip_reader_locate_file(archive_.get(), name.c_str(), nullptr, 0);
+    int index = find_member(info.filename);
+
+    if (index == -1)
+    {
+        throw std::runtime_error("not found");
+    }
+
+    // exceptions must not unwind through miniz, so they're held here until extraction stops
+    struct chunk_sink
+    {
+        const std::function<void(const char *, std::size_t)> &callback;
+        std::exception_ptr error;
+    } sink = { callback, nullptr };
+
+    auto write_chunk = [](void *opaque, mz_uint64, const void *buffer, std::size_t n) -> std::size_t
+    {
+        auto sink = static_cast<chunk_sink *>(opaque);
+
+        try
+        {
+            sink->callback(static_cast<const char *>(buffer), n);
+        }
+        catch (...)
+        {
+            sink->error = std::current_exception();
+            return 0;
+        }
+
+        return n;
+    };
+
+    auto result = mz_zip_reader_extract_to_callback(archive_.get(), static_cast<mz_uint>(index), write_chunk, &sink, 0);
 
-    return index != -1;
+    if (sink.error)
+    {
+        std::rethrow_exception(sink.error);
+    }
+
+    if (!result)
+    {
+        throw std::runtime_error("file couldn't be read");
+    }
 }
 
-bool zip_file::has_file(const zip_info &name)
+void zip_file::read(const std::string &name, const std::function<void(const char *, std::size_t)> &callback)
 {
-    return has_file(name.filename);
+    read(getinfo(name), callback);
 }
 
-std::vector<zip_info> zip_file::infolist()
+std::unique_ptr<std::istream> zip_file::read_stream(const std::string &name)
+{
+    if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
+    {
+        start_read();
+    }
+
+    int index = find_member(name);
+
+    if (index == -1)
+    {
+        throw std::runtime_error("not found");
+    }
+
+    mz_zip_archive_file_stat stat;
+    mz_zip_reader_file_stat(archive_.get(), static_cast<mz_uint>(index), &stat);
+
+    if ((stat.m_method != 0 && stat.m_method != MZ_DEFLATED) || (stat.m_bit_flag & 1))
+    {
+        throw std::runtime_error("unsupported compression method");
+    }
+
+    auto data = find_member_data(get_data(), get_size(), stat);
+
+    return std::unique_ptr<std::istream>(
+        new inflate_istream(data, static_cast<std::size_t>(stat.m_comp_size), stat.m_method == MZ_DEFLATED));
+}
+
+bool zip_file::has_file(const std::string &name)
 {
     if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
     {
         start_read();
     }
 
-    std::vector<zip_info> info;
+    return find_member(name) != -1;
+}
+
+bool zip_file::has_file(const zip_info &name)
+{
+    return has_file(name.filename);
+}
 
-    for (std::size_t i = 0; i < mz_zip_reader_get_num_files(archive_.get()); i++)
+std::vector<zip_info> zip_file::infolist()
+{
+    if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
     {
-        info.push_back(getinfo(static_cast<int>(i)));
+        start_read();
     }
 
-    return info;
+    return members_;
 }
 
 std::vector<std::string> zip_file::namelist()
@@ -780,7 +1911,7 @@ std::pair<bool, std::string> zip_file::testzip()
     for (auto &file : infolist())
     {
         auto content = read(file);
-        auto crc = crc32buf(content.c_str(), content.size());
+        auto crc = detail::compute_crc32(0, content.data(), content.size());
 
         if (crc != file.crc)
         {
@@ -796,4 +1927,9 @@ std::string zip_file::get_filename() const
     return filename_;
 }
 
+std::string zip_file::get_compression_backend()
+{
+    return detail::compression_backend();
+}
+
 } // namespace xlnt
@@ -23,6 +23,7 @@
 // @author: see AUTHORS file
 
 #include <xlnt/styles/alignment.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -76,18 +77,28 @@ void alignment::set_vertical(vertical_alignment vertical)
     vertical_ = vertical;
 }
 
-std::string alignment::to_hash_string() const
+bool alignment::operator==(const alignment &other) const
 {
-    std::string hash_string;
-
-    hash_string.append(wrap_text_ ? "1" : "0");
-    hash_string.append(shrink_to_fit_ ? "1" : "0");
-    hash_string.append(std::to_string(static_cast<std::size_t>(horizontal_)));
-    hash_string.append(std::to_string(static_cast<std::size_t>(vertical_)));
-    hash_string.append(std::to_string(text_rotation_));
-    hash_string.append(std::to_string(indent_));
-    
-    return hash_string;
+    return wrap_text_ == other.wrap_text_
+        && shrink_to_fit_ == other.shrink_to_fit_
+        && horizontal_ == other.horizontal_
+        && vertical_ == other.vertical_
+        && text_rotation_ == other.text_rotation_
+        && indent_ == other.indent_;
+}
+
+std::size_t alignment::hash() const
+{
+    std::size_t seed = 0;
+
+    hash_combine(seed, wrap_text_);
+    hash_combine(seed, shrink_to_fit_);
+    hash_combine(seed, static_cast<std::size_t>(horizontal_));
+    hash_combine(seed, static_cast<std::size_t>(vertical_));
+    hash_combine(seed, text_rotation_);
+    hash_combine(seed, indent_);
+
+    return seed;
 }
 
 } // namespace xlnt
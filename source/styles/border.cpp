@@ -22,6 +22,7 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 #include <xlnt/styles/border.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -115,38 +116,34 @@ const std::experimental::optional<side> &border::get_horizontal() const
     return horizontal_;
 }
 
-std::string border::to_hash_string() const
-{
-    std::string hash_string;
-
-    hash_string.append(start_ ? "1" : "0");
-    if (start_) hash_string.append(std::to_string(start_->hash()));
-    
-    hash_string.append(end_ ? "1" : "0");
-    if (end_) hash_string.append(std::to_string(end_->hash()));
-    
-    hash_string.append(left_ ? "1" : "0");
-    if (left_) hash_string.append(std::to_string(left_->hash()));
-    
-    hash_string.append(right_ ? "1" : "0");
-    if (right_) hash_string.append(std::to_string(right_->hash()));
-    
-    hash_string.append(top_ ? "1" : "0");
-    if (top_) hash_string.append(std::to_string(top_->hash()));
-    
-    hash_string.append(bottom_ ? "1" : "0");
-    if (bottom_) hash_string.append(std::to_string(bottom_->hash()));
-    
-    hash_string.append(diagonal_ ? "1" : "0");
-    if (diagonal_) hash_string.append(std::to_string(diagonal_->hash()));
-    
-    hash_string.append(vertical_ ? "1" : "0");
-    if (vertical_) hash_string.append(std::to_string(vertical_->hash()));
-    
-    hash_string.append(horizontal_ ? "1" : "0");
-    if (horizontal_) hash_string.append(std::to_string(horizontal_->hash()));
-
-    return hash_string;
+bool border::operator==(const border &other) const
+{
+    return start_ == other.start_
+        && end_ == other.end_
+        && left_ == other.left_
+        && right_ == other.right_
+        && top_ == other.top_
+        && bottom_ == other.bottom_
+        && diagonal_ == other.diagonal_
+        && vertical_ == other.vertical_
+        && horizontal_ == other.horizontal_;
+}
+
+std::size_t border::hash() const
+{
+    std::size_t seed = 0;
+
+    for (const auto *side : { &start_, &end_, &left_, &right_, &top_, &bottom_, &diagonal_, &vertical_, &horizontal_ })
+    {
+        hash_combine(seed, static_cast<bool>(*side));
+
+        if (*side)
+        {
+            hash_combine(seed, (*side)->hash());
+        }
+    }
+
+    return seed;
 }
 
 } // namespace xlnt
@@ -24,6 +24,7 @@
 #include <stdexcept>
 
 #include <xlnt/styles/color.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -152,22 +153,30 @@ std::string color::get_rgb_string() const
     return rgb_string_;
 }
 
-std::string color::to_hash_string() const
+bool color::operator==(const color &other) const
 {
-    std::string hash_string = "color";
-    
-    hash_string.append(std::to_string(static_cast<std::size_t>(type_)));
+    if (type_ != other.type_)
+    {
+        return false;
+    }
 
-    if (type_ != type::rgb)
+    return type_ == type::rgb ? rgb_string_ == other.rgb_string_ : index_ == other.index_;
+}
+
+std::size_t color::hash() const
+{
+    auto seed = static_cast<std::size_t>(type_);
+
+    if (type_ == type::rgb)
     {
-        hash_string.append(std::to_string(index_));
+        hash_combine(seed, rgb_string_);
     }
     else
     {
-        hash_string.append(rgb_string_);
+        hash_combine(seed, index_);
     }
 
-    return hash_string;
+    return seed;
 }
 
 } // namespace xlnt
@@ -22,6 +22,7 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 #include <xlnt/styles/base_format.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -169,29 +170,41 @@ void base_format::set_protection(const xlnt::protection &new_protection)
     }
 }
 
-std::string base_format::to_hash_string() const
-{
-    std::string hash_string("base_format:");
-    
-    hash_string.append(std::to_string(alignment_applied()));
-    hash_string.append(alignment_applied() ? std::to_string(alignment_.hash()) : ":");
-
-    hash_string.append(std::to_string(border_applied()));
-    hash_string.append(border_applied() ? std::to_string(border_.hash()) : ":");
-
-    hash_string.append(std::to_string(font_applied()));
-    hash_string.append(font_applied() ? std::to_string(font_.hash()) : ":");
-
-    hash_string.append(std::to_string(fill_applied()));
-    hash_string.append(fill_applied() ? std::to_string(fill_.hash()) : ":");
-
-    hash_string.append(std::to_string(number_format_applied()));
-    hash_string.append(std::to_string(number_format_.hash()));
-
-    hash_string.append(std::to_string(protection_applied()));
-    hash_string.append(protection_applied() ? std::to_string(protection_.hash()) : ":");
-    
-    return hash_string;
+bool base_format::operator==(const base_format &other) const
+{
+    return apply_alignment_ == other.apply_alignment_
+        && apply_border_ == other.apply_border_
+        && apply_fill_ == other.apply_fill_
+        && apply_font_ == other.apply_font_
+        && apply_number_format_ == other.apply_number_format_
+        && apply_protection_ == other.apply_protection_
+        && (!apply_alignment_ || alignment_ == other.alignment_)
+        && (!apply_border_ || border_ == other.border_)
+        && (!apply_fill_ || fill_ == other.fill_)
+        && (!apply_font_ || font_ == other.font_)
+        && number_format_ == other.number_format_
+        && (!apply_protection_ || protection_ == other.protection_);
+}
+
+std::size_t base_format::hash() const
+{
+    std::size_t seed = 0;
+
+    // components which aren't applied don't take part, apart from the number format
+    hash_combine(seed, apply_alignment_);
+    hash_combine(seed, apply_alignment_ ? alignment_.hash() : 0);
+    hash_combine(seed, apply_border_);
+    hash_combine(seed, apply_border_ ? border_.hash() : 0);
+    hash_combine(seed, apply_font_);
+    hash_combine(seed, apply_font_ ? font_.hash() : 0);
+    hash_combine(seed, apply_fill_);
+    hash_combine(seed, apply_fill_ ? fill_.hash() : 0);
+    hash_combine(seed, apply_number_format_);
+    hash_combine(seed, number_format_.hash());
+    hash_combine(seed, apply_protection_);
+    hash_combine(seed, apply_protection_ ? protection_.hash() : 0);
+
+    return seed;
 }
 
 void base_format::alignment_applied(bool applied)
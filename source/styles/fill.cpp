@@ -23,6 +23,7 @@
 // @author: see AUTHORS file
 
 #include <xlnt/styles/fill.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -91,63 +92,83 @@ double gradient_fill::get_degree() const
     return degree_;
 }
 
-std::string pattern_fill::to_hash_string() const
+bool pattern_fill::operator==(const pattern_fill &other) const
 {
-    std::string hash_string = "pattern_fill";
+    return type_ == other.type_
+        && foreground_color_ == other.foreground_color_
+        && background_color_ == other.background_color_;
+}
 
-    hash_string.append(background_color_ ? "1" : "0");
+std::size_t pattern_fill::hash() const
+{
+    auto seed = static_cast<std::size_t>(type_);
 
-    if (background_color_)
+    for (const auto *color : { &foreground_color_, &background_color_ })
     {
-        hash_string.append(std::to_string(background_color_->hash()));
+        hash_combine(seed, static_cast<bool>(*color));
+
+        if (*color)
+        {
+            hash_combine(seed, (*color)->hash());
+        }
     }
 
-    hash_string.append(background_color_ ? "1" : "0");
+    return seed;
+}
 
-    if (background_color_)
-    {
-        hash_string.append(std::to_string(background_color_->hash()));
-    }
-    
-    return hash_string;
+bool gradient_fill::operator==(const gradient_fill &other) const
+{
+    return type_ == other.type_
+        && degree_ == other.degree_
+        && left_ == other.left_
+        && right_ == other.right_
+        && top_ == other.top_
+        && bottom_ == other.bottom_
+        && stops_ == other.stops_;
 }
 
-std::string gradient_fill::to_hash_string() const
+std::size_t gradient_fill::hash() const
 {
-    std::string hash_string = "gradient_fill";
+    auto seed = static_cast<std::size_t>(type_);
+
+    hash_combine(seed, degree_);
+    hash_combine(seed, left_);
+    hash_combine(seed, right_);
+    hash_combine(seed, top_);
+    hash_combine(seed, bottom_);
+
+    // stops are unordered so they're summed rather than combined in turn
+    std::size_t stops_seed = 0;
 
-    hash_string.append(std::to_string(static_cast<std::size_t>(type_)));
-    hash_string.append(std::to_string(stops_.size()));
-    hash_string.append(std::to_string(degree_));
-    hash_string.append(std::to_string(left_));
-    hash_string.append(std::to_string(right_));
-    hash_string.append(std::to_string(top_));
-    hash_string.append(std::to_string(bottom_));
-    
-    return hash_string;
+    for (const auto &stop : stops_)
+    {
+        std::size_t stop_seed = 0;
+        hash_combine(stop_seed, stop.first);
+        hash_combine(stop_seed, stop.second.hash());
+        stops_seed += stop_seed;
+    }
+
+    hash_combine(seed, stops_seed);
+
+    return seed;
 }
 
-std::string fill::to_hash_string() const
+bool fill::operator==(const fill &other) const
 {
-    std::string hash_string = "fill";
-    
-    hash_string.append(std::to_string(static_cast<std::size_t>(type_)));
-
-    switch (type_)
+    if (type_ != other.type_)
     {
-    case type::pattern:
-        hash_string.append(std::to_string(pattern_.hash()));
-        break;
+        return false;
+    }
 
-    case type::gradient:
-        hash_string.append(std::to_string(gradient_.hash()));
-        break;
+    return type_ == type::pattern ? pattern_ == other.pattern_ : gradient_ == other.gradient_;
+}
 
-    default:
-        break;
-    } // switch (type_)
+std::size_t fill::hash() const
+{
+    auto seed = static_cast<std::size_t>(type_);
+    hash_combine(seed, type_ == type::pattern ? pattern_.hash() : gradient_.hash());
 
-    return hash_string;
+    return seed;
 }
 
 double gradient_fill::get_gradient_left() const
@@ -23,10 +23,10 @@
 // @author: see AUTHORS file
 
 #include <xlnt/styles/font.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 
 namespace xlnt {
 
-
 font::font()
     : name_("Calibri"),
       size_(12),
@@ -150,23 +150,38 @@ std::string font::get_scheme() const
     return scheme_;
 }
 
-std::string font::to_hash_string() const
+bool font::operator==(const font &other) const
+{
+    return bold_ == other.bold_
+        && italic_ == other.italic_
+        && superscript_ == other.superscript_
+        && subscript_ == other.subscript_
+        && strikethrough_ == other.strikethrough_
+        && name_ == other.name_
+        && size_ == other.size_
+        && underline_ == other.underline_
+        && color_ == other.color_
+        && family_ == other.family_
+        && scheme_ == other.scheme_;
+}
+
+std::size_t font::hash() const
 {
-    std::string hash_string = "font";
+    std::size_t seed = 0;
 
-    hash_string.append(std::to_string(bold_));
-    hash_string.append(std::to_string(italic_));
-    hash_string.append(std::to_string(superscript_));
-    hash_string.append(std::to_string(subscript_));
-    hash_string.append(std::to_string(strikethrough_));
-    hash_string.append(name_);
-    hash_string.append(std::to_string(size_));
-    hash_string.append(std::to_string(static_cast<std::size_t>(underline_)));
-    hash_string.append(std::to_string(color_.hash()));
-    hash_string.append(std::to_string(family_));
-    hash_string.append(scheme_);
+    hash_combine(seed, bold_);
+    hash_combine(seed, italic_);
+    hash_combine(seed, superscript_);
+    hash_combine(seed, subscript_);
+    hash_combine(seed, strikethrough_);
+    hash_combine(seed, name_);
+    hash_combine(seed, size_);
+    hash_combine(seed, static_cast<std::size_t>(underline_));
+    hash_combine(seed, color_.hash());
+    hash_combine(seed, family_);
+    hash_combine(seed, scheme_);
 
-    return hash_string;
+    return seed;
 }
 
 } // namespace xlnt
@@ -46,12 +46,14 @@ format &format::operator=(const format &other)
     return *this;
 }
 
-std::string format::to_hash_string() const
+bool format::operator==(const format &other) const
 {
-    auto hash_string = base_format::to_hash_string();
-    hash_string.append(":format:");
+    return base_format::operator==(other);
+}
 
-    return hash_string;
+std::size_t format::hash() const
+{
+    return base_format::hash();
 }
 
 } // namespace xlnt
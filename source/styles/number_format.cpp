@@ -266,16 +266,18 @@ std::string number_format::get_format_string() const
     return format_string_;
 }
 
-std::string number_format::to_hash_string() const
+bool number_format::operator==(const number_format &other) const
 {
-    std::string hash_string("number_format");
-    hash_string.append(format_string_);
-    hash_string.append("|||");
-    hash_string.append(std::to_string(id_));
-
-    return hash_string;
+    return id_ == other.id_ && format_string_ == other.format_string_;
 }
 
+std::size_t number_format::hash() const
+{
+    std::size_t seed = id_;
+    hash_combine(seed, format_string_);
+
+    return seed;
+}
 
 void number_format::set_format_string(const std::string &format_string)
 {
@@ -56,14 +56,19 @@ void protection::set_hidden(bool hidden)
     hidden_ = hidden;
 }
 
-std::string protection::to_hash_string() const
+bool protection::operator==(const protection &other) const
 {
-    std::string hash_string = "protection";
-    
-    hash_string.append(locked_ ? "1" : "0");
-    hash_string.append(hidden_ ? "1" : "0");
+    return locked_ == other.locked_ && hidden_ == other.hidden_;
+}
+
+std::size_t protection::hash() const
+{
+    std::size_t seed = 0;
+
+    hash_combine(seed, locked_);
+    hash_combine(seed, hidden_);
 
-    return hash_string;
+    return seed;
 }
 
 } // namespace xlnt
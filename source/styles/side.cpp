@@ -22,6 +22,7 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 #include <xlnt/styles/side.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -29,25 +30,30 @@ side::side()
 {
 }
 
-std::string side::to_hash_string() const
+bool side::operator==(const side &other) const
 {
-    std::string hash_string;
-    
-    hash_string.append(border_style_ ? "1" : "0");
-    
-    if(border_style_)
+    return border_style_ == other.border_style_ && color_ == other.color_;
+}
+
+std::size_t side::hash() const
+{
+    std::size_t seed = 0;
+
+    hash_combine(seed, static_cast<bool>(border_style_));
+
+    if (border_style_)
     {
-        hash_string.append(std::to_string(static_cast<std::size_t>(*border_style_)));
+        hash_combine(seed, static_cast<std::size_t>(*border_style_));
     }
-    
-    hash_string.append(color_ ? "1" : "0");
-    
-    if(color_)
+
+    hash_combine(seed, static_cast<bool>(color_));
+
+    if (color_)
     {
-        hash_string.append(std::to_string(color_->hash()));
+        hash_combine(seed, color_->hash());
     }
-    
-    return hash_string;
+
+    return seed;
 }
 
 std::experimental::optional<border_style> &side::get_border_style()
@@ -23,6 +23,7 @@
 // @author: see AUTHORS file
 
 #include <xlnt/styles/style.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -82,9 +83,17 @@ void style::set_name(const std::string &name)
     name_ = name;
 }
 
-std::string style::to_hash_string() const
+bool style::operator==(const style &other) const
 {
-    return base_format::to_hash_string() + name_;
+    return base_format::operator==(other) && name_ == other.name_;
+}
+
+std::size_t style::hash() const
+{
+    auto seed = base_format::hash();
+    hash_combine(seed, name_);
+
+    return seed;
 }
 
 } // namespace xlnt
@@ -53,4 +53,25 @@ public:
         TS_ASSERT_DIFFERS(gradient_fill_linear.hash(), gradient_fill_path.hash());
         TS_ASSERT_DIFFERS(gradient_fill_path.hash(), pattern_fill.hash());
     }
+
+    void test_equality()
+    {
+        xlnt::fill solid = xlnt::fill::pattern(xlnt::pattern_fill::type::solid);
+        xlnt::fill gray125 = xlnt::fill::pattern(xlnt::pattern_fill::type::gray125);
+
+        TS_ASSERT(!(solid == gray125));
+        TS_ASSERT_DIFFERS(solid.hash(), gray125.hash());
+
+        xlnt::fill copy = solid;
+        TS_ASSERT(copy == solid);
+        TS_ASSERT_EQUALS(copy.hash(), solid.hash());
+
+        copy.get_pattern_fill().set_foreground_color(xlnt::color::red());
+        TS_ASSERT(!(copy == solid));
+        TS_ASSERT_DIFFERS(copy.hash(), solid.hash());
+
+        solid.get_pattern_fill().set_foreground_color(xlnt::color::red());
+        TS_ASSERT(copy == solid);
+        TS_ASSERT_EQUALS(copy.hash(), solid.hash());
+    }
 };
@@ -60,6 +60,89 @@ public:
         TS_ASSERT_EQUALS(s, copy);
     }
 
+    void test_add_format_many()
+    {
+        xlnt::workbook wb;
+        xlnt::excel_serializer e(wb);
+        auto &stylesheet = e.get_stylesheet();
+        auto initial_formats = stylesheet.formats.size();
+        auto initial_fonts = stylesheet.fonts.size();
+
+        std::vector<std::size_t> indices;
+
+        for (int i = 0; i < 5000; i++)
+        {
+            xlnt::format f;
+            f.set_number_format(xlnt::number_format("0." + std::string(static_cast<std::size_t>(i % 50 + 1), '0'), 164 + (i % 50)));
+            xlnt::font font;
+            font.set_size(static_cast<std::size_t>(100 + i / 50));
+            f.set_font(font);
+            indices.push_back(wb.add_format(f));
+        }
+
+        TS_ASSERT_EQUALS(stylesheet.formats.size(), initial_formats + 5000);
+        TS_ASSERT_EQUALS(stylesheet.number_formats.size(), 50);
+        TS_ASSERT_EQUALS(stylesheet.fonts.size(), initial_fonts + 100);
+
+        // adding an equal format again finds the first one
+        for (std::size_t i = 0; i < 5000; i += 37)
+        {
+            auto copy = stylesheet.formats.at(indices[i]);
+            TS_ASSERT_EQUALS(wb.add_format(copy), indices[i]);
+            TS_ASSERT_EQUALS(stylesheet.index(copy), indices[i]);
+        }
+
+        TS_ASSERT_EQUALS(stylesheet.formats.size(), initial_formats + 5000);
+        TS_ASSERT_EQUALS(stylesheet.index(xlnt::number_format("0.0", 164)), 0);
+        TS_ASSERT_EQUALS(stylesheet.index(xlnt::number_format("0.0", 300)), stylesheet.number_formats.size());
+
+        // the vectors are filled directly when a stylesheet is read
+        pugi::xml_document doc;
+        auto xml = path_helper::read_file(path_helper::get_data_directory("/reader/styles/complex-styles.xml"));
+        doc.load(xml.c_str());
+        xlnt::style_serializer s(stylesheet);
+        TS_ASSERT(s.read_stylesheet(doc));
+        TS_ASSERT_EQUALS(stylesheet.fonts.size(), 8);
+
+        for (std::size_t i = 0; i < stylesheet.fonts.size(); i++)
+        {
+            TS_ASSERT_EQUALS(stylesheet.index(stylesheet.fonts[i]), std::find(stylesheet.fonts.begin(), stylesheet.fonts.end(), stylesheet.fonts[i]) - stylesheet.fonts.begin());
+        }
+    }
+
+    void test_add_format_builder()
+    {
+        xlnt::workbook wb;
+        xlnt::excel_serializer e(wb);
+        auto &stylesheet = e.get_stylesheet();
+        auto initial_formats = stylesheet.formats.size();
+
+        xlnt::font bold;
+        bold.set_bold(true);
+        xlnt::detail::format_builder bold_builder(stylesheet.formats.front());
+        bold_builder.set_font(bold);
+
+        auto bold_format = bold_builder.build();
+        TS_ASSERT_EQUALS(bold_builder.hash(), bold_format.hash());
+        TS_ASSERT(bold_builder == bold_format);
+        TS_ASSERT(!(bold_builder == stylesheet.formats.front()));
+
+        auto bold_index = stylesheet.add_format(bold_builder);
+        TS_ASSERT_EQUALS(stylesheet.formats.size(), initial_formats + 1);
+        TS_ASSERT_EQUALS(stylesheet.formats.at(bold_index), bold_format);
+
+        // finding an existing format doesn't build or add anything
+        TS_ASSERT_EQUALS(stylesheet.add_format(xlnt::detail::format_builder(bold_format).set_font(bold)), bold_index);
+        TS_ASSERT_EQUALS(stylesheet.add_format(xlnt::detail::format_builder(stylesheet.formats.front())), 0);
+        TS_ASSERT_EQUALS(stylesheet.formats.size(), initial_formats + 1);
+
+        // the default protection is ignored like it is by format::set_protection
+        xlnt::protection unchanged;
+        unchanged.set_locked(true);
+        unchanged.set_hidden(false);
+        TS_ASSERT_EQUALS(stylesheet.add_format(xlnt::detail::format_builder(stylesheet.formats.front()).set_protection(unchanged)), 0);
+    }
+
 /*
     void _test_unprotected_cell()
     {
@@ -77,6 +77,39 @@ public:
         remove_temp_file();
     }
 
+    void test_load_file_save_over()
+    {
+        remove_temp_file();
+
+        {
+            xlnt::zip_file f;
+            f.writestr("a.txt", "a\na");
+            f.comment = "first";
+            f.save(temp_file.get_filename());
+        }
+
+        {
+            xlnt::zip_file f(temp_file.get_filename());
+            TS_ASSERT_EQUALS(f.comment, "first");
+            f.comment = "second";
+            f.save(temp_file.get_filename());
+        }
+
+        {
+            xlnt::zip_file f(temp_file.get_filename());
+            TS_ASSERT_EQUALS(f.comment, "second");
+            f.writestr("b.txt", "b\nb");
+            f.save(temp_file.get_filename());
+        }
+
+        xlnt::zip_file f(temp_file.get_filename());
+        TS_ASSERT(f.read("a.txt") == "a\na");
+        TS_ASSERT(f.read("b.txt") == "b\nb");
+        TS_ASSERT_EQUALS(f.comment, "second");
+
+        remove_temp_file();
+    }
+
     void test_load_stream()
     {
         remove_temp_file();
@@ -90,6 +123,52 @@ public:
         remove_temp_file();
     }
 
+    void test_load_unseekable_stream()
+    {
+        // hands out a few bytes at a time and can't seek, like a pipe
+        struct trickle_streambuf : public std::streambuf
+        {
+            trickle_streambuf(const std::string &data) : data_(data)
+            {
+            }
+
+            int_type underflow() override
+            {
+                if (position_ == data_.size())
+                {
+                    return traits_type::eof();
+                }
+
+                auto begin = &data_[position_];
+                auto size = std::min<std::size_t>(100, data_.size() - position_);
+                position_ += size;
+                setg(begin, begin, begin + size);
+
+                return traits_type::to_int_type(*begin);
+            }
+
+            std::string data_;
+            std::size_t position_ = 0;
+        };
+
+        std::ifstream in_stream(existing_file, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in_stream)), std::istreambuf_iterator<char>());
+        xlnt::zip_file expected(existing_file);
+
+        trickle_streambuf buffer(bytes);
+        std::istream unseekable(&buffer);
+        xlnt::zip_file f(unseekable);
+        TS_ASSERT(f.namelist() == expected.namelist());
+        TS_ASSERT(f.read("[Content_Types].xml") == expected_content_types_string);
+
+        // a seekable stream is read from where it's positioned to its end
+        std::stringstream prefixed("junk" + bytes);
+        prefixed.ignore(4);
+        xlnt::zip_file g(prefixed);
+        TS_ASSERT(g.namelist() == expected.namelist());
+        TS_ASSERT(g.testzip().first);
+    }
+
     void test_load_bytes()
     {
         remove_temp_file();
@@ -157,6 +236,49 @@ public:
         TS_ASSERT(info.filename == "[Content_Types].xml");
     }
 
+    void test_getinfo_many_members()
+    {
+        std::vector<unsigned char> bytes;
+
+        {
+            xlnt::zip_file f;
+
+            for (int i = 0; i < 3000; i++)
+            {
+                f.writestr("xl/drawings/drawing" + std::to_string(i) + ".xml", std::to_string(i));
+            }
+
+            f.save(bytes);
+        }
+
+        xlnt::zip_file f(bytes);
+        TS_ASSERT_EQUALS(f.infolist().size(), 3000);
+
+        for (int i = 0; i < 3000; i += 7)
+        {
+            auto name = "xl/drawings/drawing" + std::to_string(i) + ".xml";
+            TS_ASSERT(f.has_file(name));
+            TS_ASSERT_EQUALS(f.getinfo(name).filename, name);
+            TS_ASSERT_EQUALS(f.read(name), std::to_string(i));
+        }
+
+        // names are matched without regard to case like miniz does
+        TS_ASSERT(f.has_file("XL/Drawings/Drawing12.xml"));
+        TS_ASSERT_EQUALS(f.getinfo("XL/Drawings/Drawing12.xml").filename, "xl/drawings/drawing12.xml");
+        TS_ASSERT(!f.has_file("xl/drawings/drawing3000.xml"));
+        TS_ASSERT_THROWS(f.getinfo("xl/drawings/drawing3000.xml"), std::runtime_error);
+
+        // the index follows the archive as it's written to and read again
+        f.writestr("xl/media/image1.png", "png");
+        TS_ASSERT(f.has_file("xl/media/image1.png"));
+        TS_ASSERT(f.has_file("xl/drawings/drawing2999.xml"));
+        TS_ASSERT_EQUALS(f.infolist().size(), 3001);
+
+        f.reset();
+        TS_ASSERT(!f.has_file("xl/media/image1.png"));
+        TS_ASSERT(f.infolist().empty());
+    }
+
     void test_infolist()
     {
         xlnt::zip_file f(existing_file);
@@ -233,6 +355,46 @@ public:
         TS_ASSERT(f.read(f.getinfo("[Content_Types].xml")) == expected_content_types_string);
     }
 
+    void test_read_sizes()
+    {
+        std::string large;
+
+        for (int i = 0; i < 100000; i++)
+        {
+            large.append(std::to_string(i));
+        }
+
+        xlnt::zip_file f;
+        f.writestr("empty.txt", "");
+        f.writestr("large.txt", large);
+        f.set_compression_level(xlnt::compression_level::store);
+        f.writestr("stored.txt", large);
+
+        TS_ASSERT(f.read("empty.txt").empty());
+        TS_ASSERT(f.read("large.txt") == large);
+        TS_ASSERT(f.read(f.getinfo("stored.txt")) == large);
+        TS_ASSERT_THROWS(f.read("missing.txt"), std::runtime_error);
+    }
+
+    void test_read_chunks()
+    {
+        xlnt::zip_file f(existing_file);
+        std::string contents;
+        f.read("[Content_Types].xml", [&contents](const char *data, std::size_t size) { contents.append(data, size); });
+        TS_ASSERT(contents == expected_content_types_string);
+        TS_ASSERT_THROWS(f.read("nonexistent.xml", [](const char *, std::size_t) {}), std::runtime_error);
+    }
+
+    void test_read_stream()
+    {
+        xlnt::zip_file f(existing_file);
+        auto stream = f.read_stream("[Content_Types].xml");
+        std::string contents((std::istreambuf_iterator<char>(*stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT(contents == expected_content_types_string);
+        TS_ASSERT(f.read_stream("xl/sharedStrings.xml")->get() == '<');
+        TS_ASSERT_THROWS(f.read_stream("nonexistent.xml"), std::runtime_error);
+    }
+
     void test_testzip()
     {
         xlnt::zip_file f(existing_file);
@@ -285,6 +447,217 @@ public:
         remove_temp_file();
     }
 
+    void test_writestr_loaded()
+    {
+        xlnt::zip_file original(existing_file);
+        auto names = original.namelist();
+
+        xlnt::zip_file f(existing_file);
+        f.writestr("[Content_Types].xml", "replaced");
+        f.writestr("new.txt", "new");
+
+        std::vector<unsigned char> bytes;
+        f.save(bytes);
+        xlnt::zip_file f2(bytes);
+
+        TS_ASSERT(f2.testzip().first);
+        TS_ASSERT_EQUALS(f2.namelist().size(), names.size() + 1);
+        TS_ASSERT(f2.read("[Content_Types].xml") == "replaced");
+        TS_ASSERT(f2.read("new.txt") == "new");
+
+        for (const auto &name : names)
+        {
+            if (name == "[Content_Types].xml") continue;
+
+            TS_ASSERT(f2.read(name) == original.read(name));
+            TS_ASSERT_EQUALS(f2.getinfo(name).compress_size, original.getinfo(name).compress_size);
+            TS_ASSERT_EQUALS(f2.getinfo(name).crc, original.getinfo(name).crc);
+        }
+    }
+
+    void test_writestr_deflate_ostream()
+    {
+        xlnt::deflate_ostream stream;
+        std::string expected;
+
+        for (int i = 0; i < 100000; i++)
+        {
+            auto line = "<row r=\"" + std::to_string(i) + "\"/>";
+            stream << line;
+            expected.append(line);
+        }
+
+        xlnt::zip_file f;
+        f.writestr("rows.xml", stream);
+        TS_ASSERT(stream.is_finished());
+        TS_ASSERT_EQUALS(stream.get_uncompressed_size(), expected.size());
+        TS_ASSERT_LESS_THAN(stream.get_compressed().size(), expected.size());
+
+        std::vector<unsigned char> bytes;
+        f.save(bytes);
+        xlnt::zip_file f2(bytes);
+        TS_ASSERT(f2.read("rows.xml") == expected);
+        TS_ASSERT(f2.testzip().first);
+    }
+
+    void test_compression_level()
+    {
+        std::string content;
+
+        for (int i = 0; i < 10000; i++)
+        {
+            content.append("<c r=\"A" + std::to_string(i) + "\"><v>" + std::to_string(i * 7) + "</v></c>");
+        }
+
+        xlnt::deflate_ostream stream(xlnt::compression_level::store);
+        stream << content;
+
+        xlnt::zip_file f;
+        TS_ASSERT_EQUALS(f.get_compression_level(), xlnt::compression_level::best);
+        f.set_compression_level(xlnt::compression_level::store);
+        f.set_compression_level("fast.xml", xlnt::compression_level::fast);
+        TS_ASSERT_EQUALS(f.get_compression_level("fast.xml"), xlnt::compression_level::fast);
+        TS_ASSERT_EQUALS(f.get_compression_level("stored.xml"), xlnt::compression_level::store);
+        f.writestr("stored.xml", content);
+        f.writestr("fast.xml", content);
+        f.writestr("streamed.xml", stream);
+
+        std::vector<unsigned char> bytes;
+        f.save(bytes);
+        xlnt::zip_file f2(bytes);
+        TS_ASSERT(f2.testzip().first);
+
+        for (auto name : { "stored.xml", "fast.xml", "streamed.xml" })
+        {
+            TS_ASSERT(f2.read(name) == content);
+        }
+
+        TS_ASSERT_EQUALS(f2.getinfo("stored.xml").compress_size, content.size());
+        TS_ASSERT_EQUALS(f2.getinfo("streamed.xml").compress_size, content.size());
+        TS_ASSERT_LESS_THAN(f2.getinfo("fast.xml").compress_size, content.size());
+    }
+
+    void test_parallel_compression()
+    {
+        std::string content;
+
+        for (int i = 0; i < 10000; i++)
+        {
+            content.append("<c r=\"A" + std::to_string(i) + "\"><v>" + std::to_string(i * 7) + "</v></c>");
+        }
+
+        std::vector<unsigned char> serial_bytes, parallel_bytes;
+
+        for (auto parallel : { false, true })
+        {
+            xlnt::zip_file f;
+            TS_ASSERT(!f.get_parallel_compression());
+            f.set_parallel_compression(parallel);
+            f.set_compression_level("stored.xml", xlnt::compression_level::store);
+            f.writestr("empty.xml", "");
+            f.writestr("tiny.xml", "abc");
+            f.writestr("stored.xml", content);
+            f.writestr("a.xml", content);
+            f.writestr("b.xml", content.substr(100));
+            f.save(parallel ? parallel_bytes : serial_bytes);
+        }
+
+        TS_ASSERT_EQUALS(serial_bytes.size(), parallel_bytes.size());
+
+        xlnt::zip_file serial(serial_bytes), parallel(parallel_bytes);
+        TS_ASSERT(parallel.namelist() == serial.namelist());
+
+        for (auto info : serial.infolist())
+        {
+            auto parallel_info = parallel.getinfo(info.filename);
+            TS_ASSERT_EQUALS(parallel_info.header_offset, info.header_offset);
+            TS_ASSERT_EQUALS(parallel_info.compress_size, info.compress_size);
+            TS_ASSERT_EQUALS(parallel_info.crc, info.crc);
+            TS_ASSERT(parallel.read(info) == serial.read(info));
+        }
+    }
+
+    void test_compression_backend()
+    {
+        auto backend = xlnt::zip_file::get_compression_backend();
+        TS_ASSERT(backend == "miniz" || backend == "libdeflate" || backend == "zlib-ng");
+
+        std::string content;
+
+        for (int i = 0; i < 10000; i++)
+        {
+            content.append("<c r=\"B" + std::to_string(i) + "\" s=\"" + std::to_string(i % 13) + "\"/>");
+        }
+
+        std::vector<unsigned char> bytes;
+
+        {
+            xlnt::zip_file f;
+            f.set_compression_level("stored.xml", xlnt::compression_level::store);
+            f.set_compression_level("fast.xml", xlnt::compression_level::fast);
+            f.set_compression_level("normal.xml", xlnt::compression_level::normal);
+            f.writestr("check.txt", "123456789");
+            f.writestr("stored.xml", content);
+            f.writestr("fast.xml", content);
+            f.writestr("normal.xml", content);
+            f.writestr("best.xml", content);
+            f.save(bytes);
+        }
+
+        xlnt::zip_file f(bytes);
+        TS_ASSERT_EQUALS(f.getinfo("check.txt").crc, 0xCBF43926);
+        TS_ASSERT_EQUALS(f.read("check.txt"), "123456789");
+
+        for (auto name : { "stored.xml", "fast.xml", "normal.xml", "best.xml" })
+        {
+            TS_ASSERT_EQUALS(f.getinfo(name).crc, f.getinfo("stored.xml").crc);
+            TS_ASSERT(f.read(name) == content);
+        }
+
+        TS_ASSERT(f.getinfo("best.xml").compress_size < content.size() / 4);
+        TS_ASSERT(f.testzip().first);
+
+        // a damaged member fails its CRC check
+        auto stored = f.getinfo("stored.xml");
+        bytes[stored.header_offset + 30 + stored.filename.size() + 10] ^= 0x01;
+        xlnt::zip_file damaged(bytes);
+        TS_ASSERT_THROWS(damaged.read("stored.xml"), std::runtime_error);
+        TS_ASSERT(damaged.read("best.xml") == content);
+    }
+
+    void test_begin_save()
+    {
+        std::ostringstream stream;
+        std::vector<unsigned char> bytes;
+
+        xlnt::zip_file to_stream, to_bytes;
+        to_stream.begin_save(stream);
+        to_bytes.begin_save(bytes);
+
+        for (auto f : { &to_stream, &to_bytes })
+        {
+            f->writestr("a.txt", "a\na");
+            f->writestr("b.txt", std::string(100000, 'b'));
+            f->comment = "comment";
+        }
+
+        TS_ASSERT_THROWS(to_stream.read("a.txt"), std::runtime_error);
+        to_stream.save(stream);
+        to_bytes.save(bytes);
+
+        auto streamed = stream.str();
+        TS_ASSERT_EQUALS(streamed.size(), bytes.size());
+
+        for (auto saved_bytes : { std::vector<unsigned char>(streamed.begin(), streamed.end()), bytes })
+        {
+            xlnt::zip_file saved(saved_bytes);
+            TS_ASSERT(saved.testzip().first);
+            TS_ASSERT(saved.read("a.txt") == "a\na");
+            TS_ASSERT(saved.read("b.txt") == std::string(100000, 'b'));
+            TS_ASSERT_EQUALS(saved.comment, "comment");
+        }
+    }
+
     void test_comment()
     {
         remove_temp_file();
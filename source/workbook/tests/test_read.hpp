@@ -8,8 +8,12 @@
 #include <detail/manifest_serializer.hpp>
 #include <detail/relationship_serializer.hpp>
 #include <detail/shared_strings_serializer.hpp>
+#include <detail/stylesheet.hpp>
 #include <detail/workbook_serializer.hpp>
+#include <detail/worksheet_sax_handler.hpp>
+#include <detail/xml_sax_parser.hpp>
 #include <helpers/path_helper.hpp>
+#include <helpers/temporary_file.hpp>
 #include <xlnt/cell/text.hpp>
 #include <xlnt/cell/text_run.hpp>
 #include <xlnt/packaging/manifest.hpp>
@@ -53,6 +57,143 @@ public:
         TS_ASSERT_EQUALS(false, sheet2.get_cell("G10").get_value<bool>());
     }
 
+    void test_read_only()
+    {
+        auto expected = standard_workbook();
+        
+        xlnt::workbook wb;
+        wb.set_read_only(true);
+        wb.load(path_helper::get_data_directory("/genuine/empty.xlsx"));
+        TS_ASSERT(wb.get_read_only());
+        TS_ASSERT_THROWS(wb.create_sheet(), xlnt::read_only_workbook_error);
+        TS_ASSERT_THROWS(wb.create_sheet("Another"), xlnt::read_only_workbook_error);
+        
+        auto sheet2 = wb.get_sheet_by_name("Sheet2 - Numbers");
+        auto expected_sheet2 = expected.get_sheet_by_name("Sheet2 - Numbers");
+        TS_ASSERT_EQUALS(sheet2.calculate_dimension(), expected_sheet2.calculate_dimension());
+        
+        std::size_t cells = 0;
+        
+        for (auto row : sheet2.rows())
+        {
+            for (auto cell : row)
+            {
+                auto expected_cell = expected_sheet2.get_cell(cell.get_reference());
+                TS_ASSERT_EQUALS(cell.get_data_type(), expected_cell.get_data_type());
+                TS_ASSERT_EQUALS(cell.to_string(), expected_cell.to_string());
+                cells += cell.has_value() ? 1 : 0;
+            }
+        }
+        
+        TS_ASSERT_DIFFERS(cells, 0);
+        
+        // going back to an earlier row restarts the stream
+        TS_ASSERT_EQUALS("This is cell G5", sheet2.get_cell("G5").get_value<std::string>());
+        TS_ASSERT_EQUALS(18, sheet2.get_cell("D18").get_value<int>());
+        TS_ASSERT(!sheet2.has_cell("Z1000"));
+    }
+
+    void test_read_only_save_over_source()
+    {
+        temporary_file temp_file;
+
+        {
+            std::ifstream source(path_helper::get_data_directory("/genuine/empty.xlsx"), std::ios::binary);
+            std::ofstream destination(temp_file.get_filename(), std::ios::binary);
+            destination << source.rdbuf();
+        }
+
+        xlnt::workbook wb;
+        wb.set_read_only(true);
+        TS_ASSERT(wb.load(temp_file.get_filename()));
+
+        // a different path to the same file must still release the mapping first
+        auto filename = temp_file.get_filename();
+        auto separator = filename.find_last_of('/');
+        auto other_path = filename.substr(0, separator + 1) + "./" + filename.substr(separator + 1);
+        TS_ASSERT(wb.save(other_path));
+
+        xlnt::workbook reloaded;
+        TS_ASSERT(reloaded.load(temp_file.get_filename()));
+        auto sheet2 = reloaded.get_sheet_by_name("Sheet2 - Numbers");
+        TS_ASSERT_EQUALS("This is cell G5", sheet2.get_cell("G5").get_value<std::string>());
+        TS_ASSERT_EQUALS(18, sheet2.get_cell("D18").get_value<int>());
+    }
+
+    void test_read_only_save_inline_strings()
+    {
+        // Sheet1!A1 is an inline string, which is only added to the shared strings
+        // when the streamed sheet is read again to be saved
+        xlnt::workbook wb;
+        wb.set_read_only(true);
+        wb.load(path_helper::get_data_directory("/genuine/empty.xlsx"));
+
+        std::vector<unsigned char> bytes;
+        TS_ASSERT(wb.save(bytes));
+
+        xlnt::workbook reloaded;
+        TS_ASSERT(reloaded.load(bytes));
+        TS_ASSERT_EQUALS(reloaded.get_sheet_by_index(0).get_cell("A1").get_value<std::string>(), "This is cell A1 in Sheet 1");
+
+        auto sheet2 = reloaded.get_sheet_by_name("Sheet2 - Numbers");
+        TS_ASSERT_EQUALS("This is cell G5", sheet2.get_cell("G5").get_value<std::string>());
+        TS_ASSERT_EQUALS(18, sheet2.get_cell("D18").get_value<int>());
+    }
+
+    void test_read_repeated_shared_strings()
+    {
+        xlnt::workbook original;
+        auto ws = original.get_active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(1, row)).set_value("N/A");
+        }
+
+        std::vector<unsigned char> bytes;
+        TS_ASSERT(original.save(bytes));
+
+        xlnt::workbook wb;
+        TS_ASSERT(wb.load(bytes));
+        TS_ASSERT_EQUALS(wb.get_shared_strings().size(), 1);
+        TS_ASSERT_EQUALS(wb.get_active_sheet().get_cell("A100").get_data_type(), xlnt::cell::type::string);
+        TS_ASSERT_EQUALS(wb.get_active_sheet().get_cell("A100").get_value<std::string>(), "N/A");
+    }
+
+    void test_read_parallel()
+    {
+        auto path = path_helper::get_data_directory("/genuine/empty.xlsx");
+
+        xlnt::workbook sequential;
+        sequential.load(path);
+
+        xlnt::workbook parallel;
+        parallel.set_parallel_load(true);
+        TS_ASSERT(parallel.load(path));
+
+        TS_ASSERT_EQUALS(parallel.get_sheet_names(), sequential.get_sheet_names());
+        TS_ASSERT_EQUALS(parallel.get_shared_strings().size(), sequential.get_shared_strings().size());
+
+        for (auto ws : sequential)
+        {
+            auto parallel_ws = parallel.get_sheet_by_name(ws.get_title());
+            TS_ASSERT_EQUALS(parallel_ws.calculate_dimension(), ws.calculate_dimension());
+            TS_ASSERT_EQUALS(parallel_ws.get_merged_ranges().size(), ws.get_merged_ranges().size());
+
+            for (auto row : ws.rows())
+            {
+                for (auto cell : row)
+                {
+                    auto parallel_cell = parallel_ws.get_cell(cell.get_reference());
+                    TS_ASSERT_EQUALS(parallel_cell.get_data_type(), cell.get_data_type());
+                    TS_ASSERT_EQUALS(parallel_cell.to_string(), cell.to_string());
+                    TS_ASSERT_EQUALS(parallel_cell.has_format(), cell.has_format());
+                    TS_ASSERT_EQUALS(parallel_cell.get_number_format(), cell.get_number_format());
+                }
+            }
+        }
+    }
+
     void test_read_nostring_workbook()
     {
         auto path = path_helper::get_data_directory("/genuine/empty-no-string.xlsx");
@@ -547,6 +688,112 @@ public:
         TS_ASSERT_THROWS(xlnt::shared_strings_serializer::read_shared_strings(xml_bad, strings), std::runtime_error);
     }
 
+    void test_read_xml_in_chunks()
+    {
+        struct event_recorder : public xlnt::detail::sax_handler
+        {
+            void start_element(const std::string &name, const xlnt::detail::sax_attributes &attributes) override
+            {
+                events += "<" + name;
+
+                for (std::size_t i = 0; i < attributes.size(); i++)
+                {
+                    events += " " + attributes[i].name + "=" + attributes[i].value;
+                }
+
+                events += ">";
+            }
+
+            void end_element(const std::string &name) override
+            {
+                events += "</" + name + ">";
+            }
+
+            void characters(const std::string &text) override
+            {
+                events += text;
+            }
+
+            std::string events;
+        };
+
+        std::string source =
+            "<?xml version=\"1.0\"?>\r\n"
+            "<sheetData><!-- a > comment -->"
+            "<row r=\"1\" spans='1:2'><c r=\"A1\" t=\"str\"><v>a &amp; b &#x263A;</v></c>"
+            "<c r=\"B1\" note=\"x>y\"/></row><![CDATA[<raw>]]></sheetData>";
+        std::string expected = "<sheetData><row r=1 spans=1:2><c r=A1 t=str><v>a & b \xE2\x98\xBA</v></c>"
+            "<c r=B1 note=x>y></c></row><raw></sheetData>";
+
+        // every token must survive being split at any point
+        event_recorder recorder;
+        xlnt::detail::xml_sax_parser parser(recorder);
+
+        for (auto c : source)
+        {
+            parser.feed(&c, 1);
+        }
+
+        parser.finish();
+        TS_ASSERT_EQUALS(recorder.events, expected);
+
+        event_recorder truncated_recorder;
+        xlnt::detail::xml_sax_parser truncated_parser(truncated_recorder);
+        truncated_parser.feed(source.data(), source.size() - 5);
+        TS_ASSERT_THROWS(truncated_parser.finish(), std::runtime_error);
+
+        event_recorder decimal_recorder;
+        xlnt::detail::xml_sax_parser decimal_parser(decimal_recorder);
+        std::string decimal = "<v>&#65;&#x42;</v>";
+        decimal_parser.feed(decimal.data(), decimal.size());
+        decimal_parser.finish();
+        TS_ASSERT_EQUALS(decimal_recorder.events, "<v>AB</v>");
+
+        for (std::string reference : { "&#;", "&#x;", "&#12a;", "&#xZZ;", "&#-1;", "&#x110000;", "&#0;", "&#xD800;", "&#99999999999999999999;" })
+        {
+            event_recorder bad_recorder;
+            xlnt::detail::xml_sax_parser bad_parser(bad_recorder);
+            auto bad = "<v>" + reference + "</v>";
+            TS_ASSERT_THROWS(bad_parser.feed(bad.data(), bad.size()), std::runtime_error);
+        }
+    }
+
+    void test_read_optional_and_missing_attributes()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::detail::stylesheet stylesheet;
+
+        std::string source =
+            "<worksheet><cols><col min=\"1\" max=\"2\"/>"
+            "<col min=\"4\" max=\"6\" width=\"20\" customWidth=\"1\"/></cols>"
+            "<sheetData/></worksheet>";
+
+        xlnt::detail::worksheet_sax_handler handler(ws, stylesheet);
+        xlnt::detail::xml_sax_parser parser(handler);
+        parser.feed(source.data(), source.size());
+        parser.finish();
+
+        // width is optional
+        TS_ASSERT(ws.has_column_properties(2));
+        TS_ASSERT_EQUALS(ws.get_column_properties(2).width, 0);
+
+        // every column of a span gets its properties
+        for (xlnt::column_t::index_t column = 4; column <= 6; column++)
+        {
+            TS_ASSERT_EQUALS(ws.get_column_properties(column).width, 20);
+            TS_ASSERT(ws.get_column_properties(column).custom);
+        }
+
+        for (std::string missing : { "<mergeCells><mergeCell/></mergeCells>", "<autoFilter/>", "<cols><col max=\"1\"/></cols>" })
+        {
+            xlnt::detail::worksheet_sax_handler bad_handler(ws, stylesheet);
+            xlnt::detail::xml_sax_parser bad_parser(bad_handler);
+            auto bad = "<worksheet>" + missing + "</worksheet>";
+            TS_ASSERT_THROWS(bad_parser.feed(bad.data(), bad.size()), xlnt::invalid_file_error);
+        }
+    }
+
     void test_read_inlinestr()
     {
         xlnt::workbook wb;
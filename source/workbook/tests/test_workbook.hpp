@@ -377,4 +377,32 @@ public:
     {
         
     }
+
+    void test_add_shared_string()
+    {
+        xlnt::workbook wb;
+
+        xlnt::text first;
+        first.set_plain_string("first");
+        xlnt::text second;
+        second.set_plain_string("second");
+
+        TS_ASSERT_EQUALS(wb.add_shared_string(first), 0);
+        TS_ASSERT_EQUALS(wb.add_shared_string(second), 1);
+        TS_ASSERT_EQUALS(wb.add_shared_string(first), 0);
+        TS_ASSERT_EQUALS(wb.add_shared_string(first, true), 2);
+        TS_ASSERT_EQUALS(wb.get_shared_strings().size(), 3);
+
+        xlnt::text_run sized_run;
+        sized_run.set_string("first");
+        sized_run.set_size(14);
+        xlnt::text sized;
+        sized.add_run(sized_run);
+
+        TS_ASSERT_EQUALS(wb.add_shared_string(sized), 3);
+        TS_ASSERT_EQUALS(wb.add_shared_string(sized), 3);
+
+        xlnt::workbook copy(wb);
+        TS_ASSERT_EQUALS(copy.add_shared_string(second), 1);
+    }
 };
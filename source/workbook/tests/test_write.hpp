@@ -42,6 +42,172 @@ public:
         TS_ASSERT(new_wb.load(saved_wb));
     }
 
+    void test_write_optimized()
+    {
+        xlnt::workbook wb;
+        wb.set_optimized_write(true);
+        auto ws = wb.get_active_sheet();
+        ws.get_column_properties(2).width = 20;
+        ws.get_column_properties(2).custom = true;
+
+        for (int i = 1; i <= 1000; i++)
+        {
+            ws.append(std::vector<std::string>{"row", std::to_string(i)});
+            ws.append(std::vector<int>{i, i * 2});
+        }
+
+        // only the last appended row is kept
+        TS_ASSERT(!ws.has_cell("A1"));
+        TS_ASSERT(ws.has_cell("B2000"));
+        TS_ASSERT_EQUALS(ws.get_next_row(), 2001);
+
+        std::vector<unsigned char> bytes;
+        TS_ASSERT(wb.save(bytes));
+        TS_ASSERT_THROWS(ws.append(std::vector<int>{1}), std::runtime_error);
+
+        xlnt::workbook loaded;
+        TS_ASSERT(loaded.load(bytes));
+        auto loaded_ws = loaded.get_active_sheet();
+        TS_ASSERT_EQUALS(loaded_ws.get_cell("A1").get_value<std::string>(), "row");
+        TS_ASSERT_EQUALS(loaded_ws.get_cell("B1").get_value<std::string>(), "1");
+        TS_ASSERT_EQUALS(loaded_ws.get_cell("B2000").get_value<int>(), 2000);
+        TS_ASSERT_EQUALS(loaded_ws.calculate_dimension(), xlnt::range_reference("A1:B2000"));
+        TS_ASSERT_EQUALS(loaded_ws.get_column_properties(2).width, 20);
+    }
+
+    void test_write_optimized_hyperlink()
+    {
+        xlnt::workbook wb;
+        wb.set_optimized_write(true);
+        auto ws = wb.get_active_sheet();
+
+        ws.append(std::vector<std::string>{"link"});
+        ws.get_cell("A1").set_hyperlink("http://example.com");
+
+        // this writes the first row, and the part before it, while the hyperlink is pending
+        TS_ASSERT_THROWS_NOTHING(ws.append(std::vector<std::string>{"after"}));
+
+        std::vector<unsigned char> bytes;
+        TS_ASSERT_THROWS_NOTHING(wb.save(bytes));
+
+        xlnt::zip_file archive(bytes);
+        auto sheet_xml = archive.read("xl/worksheets/sheet1.xml");
+        TS_ASSERT(sheet_xml.find("<hyperlink display=\"http://example.com\" ref=\"A1\"") != std::string::npos);
+    }
+
+    void test_write_optimized_copy()
+    {
+        xlnt::workbook wb;
+        wb.set_optimized_write(true);
+        auto ws = wb.get_active_sheet();
+        ws.append(std::vector<std::string>{"first"});
+        ws.append(std::vector<std::string>{"second"});
+
+        TS_ASSERT_THROWS(wb.copy_sheet(ws), std::runtime_error);
+        TS_ASSERT_THROWS(xlnt::workbook copy(wb), std::runtime_error);
+
+        // other sheets can still be added after rows have been written
+        wb.create_sheet().append(std::vector<std::string>{"other"});
+        std::vector<unsigned char> bytes;
+        TS_ASSERT_THROWS_NOTHING(wb.save(bytes));
+    }
+
+    void test_write_copy_unmodified_sheets()
+    {
+        auto path = path_helper::get_data_directory("/genuine/empty.xlsx");
+        xlnt::zip_file original(path);
+
+        xlnt::workbook wb;
+        TS_ASSERT(!wb.get_copy_unmodified_sheets());
+        wb.set_copy_unmodified_sheets(true);
+        wb.load(path);
+        wb.get_sheet_by_name("Sheet2 - Numbers").get_cell("A1").set_value("changed");
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+        xlnt::zip_file archive(bytes);
+
+        for (auto part : { "xl/worksheets/sheet1.xml", "xl/worksheets/sheet3.xml", "xl/worksheets/sheet4.xml" })
+        {
+            TS_ASSERT(archive.read(part) == original.read(part));
+            TS_ASSERT_EQUALS(archive.getinfo(part).compress_size, original.getinfo(part).compress_size);
+        }
+
+        TS_ASSERT(archive.read("xl/worksheets/sheet2.xml") != original.read("xl/worksheets/sheet2.xml"));
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        TS_ASSERT_EQUALS(loaded.get_sheet_by_name("Sheet2 - Numbers").get_cell("A1").get_value<std::string>(), "changed");
+        TS_ASSERT_EQUALS(loaded.get_sheet_by_name("Sheet1 - Text").get_cell("A1").get_value<std::string>(),
+            wb.get_sheet_by_name("Sheet1 - Text").get_cell("A1").get_value<std::string>());
+    }
+
+    void test_write_copy_unmodified_sheets_with_relationships()
+    {
+        // sheet2.xml refers to printer settings through its relationships
+        auto path = path_helper::get_data_directory("/genuine/tab_order.xlsx");
+        xlnt::zip_file original(path);
+        TS_ASSERT(original.has_file("xl/worksheets/_rels/sheet2.xml.rels"));
+
+        xlnt::workbook wb;
+        wb.set_copy_unmodified_sheets(true);
+        wb.load(path);
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+        xlnt::zip_file archive(bytes);
+
+        TS_ASSERT(archive.read("xl/worksheets/sheet1.xml") == original.read("xl/worksheets/sheet1.xml"));
+        TS_ASSERT(!archive.has_file("xl/worksheets/_rels/sheet2.xml.rels"));
+        TS_ASSERT(archive.read("xl/worksheets/sheet2.xml").find("r:id") == std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        TS_ASSERT_EQUALS(loaded.get_sheet_by_name("Project").get_cell("A1").get_value<std::string>(),
+            wb.get_sheet_by_name("Project").get_cell("A1").get_value<std::string>());
+    }
+
+    void test_write_compact_styles()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::font font;
+
+        // each of these leaves the format set before it unused
+        for (std::size_t size = 100; size < 110; size++)
+        {
+            font.set_size(size);
+            ws.get_cell("A1").set_font(font);
+        }
+
+        xlnt::font bold;
+        bold.set_bold(true);
+        ws.get_cell("B1").set_font(bold);
+
+        std::vector<std::uint8_t> uncompacted;
+        wb.save(uncompacted);
+        TS_ASSERT_THROWS_NOTHING(wb.get_format(11));
+
+        TS_ASSERT(!wb.get_compact_styles());
+        wb.set_compact_styles(true);
+        std::vector<std::uint8_t> compacted;
+        wb.save(compacted);
+
+        // the default format and the two in use are left
+        TS_ASSERT_THROWS_NOTHING(wb.get_format(2));
+        TS_ASSERT_THROWS(wb.get_format(3), std::out_of_range);
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_font().get_size(), 109);
+        TS_ASSERT(ws.get_cell("B1").get_font().is_bold());
+        TS_ASSERT(xlnt::zip_file(compacted).read("xl/styles.xml").size() < xlnt::zip_file(uncompacted).read("xl/styles.xml").size());
+
+        xlnt::workbook loaded;
+        loaded.load(compacted);
+        auto loaded_ws = loaded.get_active_sheet();
+        TS_ASSERT_EQUALS(loaded_ws.get_cell("A1").get_font().get_size(), 109);
+        TS_ASSERT(loaded_ws.get_cell("B1").get_font().is_bold());
+        TS_ASSERT(!loaded_ws.get_cell("B1").get_font().is_italic());
+    }
+
     void test_write_workbook_rels()
     {
         xlnt::workbook wb;
@@ -286,6 +452,23 @@ public:
         
         TS_ASSERT(xml_helper::compare_xml(path_helper::get_data_directory() + "/writer/expected/short_number.xml", xml));
     }
+
+    void test_write_empty_string()
+    {
+        xlnt::workbook wb;
+        wb.get_active_sheet().get_cell("A1").set_value("");
+        wb.get_active_sheet().get_cell("A2").set_value("xlnt");
+
+        std::vector<unsigned char> bytes;
+        TS_ASSERT(wb.save(bytes));
+
+        xlnt::workbook loaded;
+        TS_ASSERT(loaded.load(bytes));
+        auto ws = loaded.get_active_sheet();
+        TS_ASSERT(ws.get_cell("A1").get_data_type() == xlnt::cell::type::string);
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_value<std::string>(), "");
+        TS_ASSERT_EQUALS(ws.get_cell("A2").get_value<std::string>(), "xlnt");
+    }
     
     void _test_write_images()
     {
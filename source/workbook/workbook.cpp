@@ -35,6 +35,7 @@
 #include <detail/workbook_impl.hpp>
 #include <detail/worksheet_impl.hpp>
 #include <xlnt/packaging/app_properties.hpp>
+#include <xlnt/packaging/compression_level.hpp>
 #include <xlnt/packaging/document_properties.hpp>
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/packaging/relationship.hpp>
@@ -63,7 +64,13 @@ workbook_impl::workbook_impl()
     : active_sheet_index_(0),
       guess_types_(false),
       data_only_(false),
-      read_only_(false)
+      read_only_(false),
+      optimized_write_(false),
+      parallel_load_(false),
+      parallel_save_(false),
+      copy_unmodified_sheets_(false),
+      compact_styles_(false),
+      compression_level_(compression_level::best)
 {
 }
 
@@ -157,7 +164,12 @@ worksheet workbook::create_sheet()
     {
         title = "Sheet" + std::to_string(++index);
     }
-    
+
+    return add_sheet(title);
+}
+
+worksheet workbook::add_sheet(const std::string &title)
+{
     std::string sheet_filename = "sheet" + std::to_string(d_->worksheets_.size() + 1) + ".xml";
 
     d_->worksheets_.push_back(detail::worksheet_impl(this, title));
@@ -174,6 +186,11 @@ void workbook::copy_sheet(xlnt::worksheet worksheet)
 {
     if(worksheet.d_->parent_ != this) throw xlnt::value_error();
 
+    if (worksheet.d_->row_writer_)
+    {
+        throw std::runtime_error("can't copy a worksheet which has had rows written in optimized write mode");
+    }
+
     xlnt::detail::worksheet_impl impl(*worksheet.d_);
     auto new_sheet = create_sheet();
     impl.title_ = new_sheet.get_title();
@@ -353,6 +370,13 @@ worksheet workbook::create_sheet(std::size_t index, const std::string &title)
 }
 
 worksheet workbook::create_sheet(const std::string &title)
+{
+    if(get_read_only()) throw xlnt::read_only_workbook_error();
+
+    return add_sheet(validate_sheet_title(title));
+}
+
+std::string workbook::validate_sheet_title(const std::string &title) const
 {
     if (title.length() > 31)
     {
@@ -383,10 +407,7 @@ worksheet workbook::create_sheet(const std::string &title)
         }
     }
 
-    auto ws = create_sheet();
-    ws.set_title(unique_title);
-
-    return ws;
+    return unique_title;
 }
 
 workbook::iterator workbook::begin()
@@ -532,6 +553,14 @@ workbook::workbook(workbook &&other) : workbook()
 
 workbook::workbook(const workbook &other) : workbook()
 {
+    for (const auto &ws : other.d_->worksheets_)
+    {
+        if (ws.row_writer_)
+        {
+            throw std::runtime_error("can't copy a workbook with worksheets which have had rows written in optimized write mode");
+        }
+    }
+
     *d_.get() = *other.d_.get();
 
     for (auto ws : *this)
@@ -564,6 +593,77 @@ void workbook::set_read_only(bool read_only)
     d_->read_only_ = read_only;
 }
 
+bool workbook::get_optimized_write() const
+{
+    return d_->optimized_write_;
+}
+
+void workbook::set_optimized_write(bool optimized_write)
+{
+    d_->optimized_write_ = optimized_write;
+}
+
+bool workbook::get_parallel_load() const
+{
+    return d_->parallel_load_;
+}
+
+void workbook::set_parallel_load(bool parallel_load)
+{
+    d_->parallel_load_ = parallel_load;
+}
+
+bool workbook::get_parallel_save() const
+{
+    return d_->parallel_save_;
+}
+
+void workbook::set_parallel_save(bool parallel_save)
+{
+    d_->parallel_save_ = parallel_save;
+}
+
+bool workbook::get_copy_unmodified_sheets() const
+{
+    return d_->copy_unmodified_sheets_;
+}
+
+void workbook::set_copy_unmodified_sheets(bool copy_unmodified_sheets)
+{
+    d_->copy_unmodified_sheets_ = copy_unmodified_sheets;
+}
+
+bool workbook::get_compact_styles() const
+{
+    return d_->compact_styles_;
+}
+
+void workbook::set_compact_styles(bool compact_styles)
+{
+    d_->compact_styles_ = compact_styles;
+}
+
+compression_level workbook::get_compression_level() const
+{
+    return d_->compression_level_;
+}
+
+void workbook::set_compression_level(compression_level level)
+{
+    d_->compression_level_ = level;
+}
+
+compression_level workbook::get_compression_level(const std::string &part) const
+{
+    auto match = d_->part_compression_levels_.find(part);
+    return match == d_->part_compression_levels_.end() ? d_->compression_level_ : match->second;
+}
+
+void workbook::set_compression_level(const std::string &part, compression_level level)
+{
+    d_->part_compression_levels_[part] = level;
+}
+
 void workbook::set_code_name(const std::string & /*code_name*/)
 {
 }
@@ -625,6 +725,7 @@ void workbook::clear_styles()
 void workbook::clear_formats()
 {
     d_->stylesheet_.formats.clear();
+    d_->stylesheet_.format_index.clear();
     apply_to_cells([](cell c) { c.clear_format(); });
 }
 
@@ -642,11 +743,6 @@ void workbook::apply_to_cells(std::function<void(cell)> f)
     }
 }
 
-format &workbook::get_format(std::size_t format_index)
-{
-    return d_->stylesheet_.formats.at(format_index);
-}
-
 const format &workbook::get_format(std::size_t format_index) const
 {
     return d_->stylesheet_.formats.at(format_index);
@@ -687,7 +783,7 @@ const std::vector<text> &workbook::get_shared_strings() const
     return d_->shared_strings_;
 }
 
-void workbook::add_shared_string(const text &shared, bool allow_duplicates)
+std::size_t workbook::add_shared_string(const text &shared, bool allow_duplicates)
 {
     if (d_->shared_strings_.empty())
     {
@@ -695,16 +791,27 @@ void workbook::add_shared_string(const text &shared, bool allow_duplicates)
         d_->manifest_.add_override_type("/" + constants::part_shared_strings(), "application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml");
     }
 
+    auto hash = std::hash<std::string>()(shared.get_plain_string());
+
 	if (!allow_duplicates)
 	{
-		//TODO: inefficient, use a set or something?
-		for (auto &s : d_->shared_strings_)
-		{
-			if (s == shared) return;
-		}
+        auto matches = d_->shared_string_index_.equal_range(hash);
+
+        for (auto match = matches.first; match != matches.second; ++match)
+        {
+            auto index = match->second;
+
+            if (index < d_->shared_strings_.size() && d_->shared_strings_[index] == shared)
+            {
+                return index;
+            }
+        }
 	}
     
     d_->shared_strings_.push_back(shared);
+    d_->shared_string_index_.emplace(hash, d_->shared_strings_.size() - 1);
+
+    return d_->shared_strings_.size() - 1;
 }
 
 bool workbook::contains(const std::string &sheet_title) const
@@ -20,13 +20,20 @@
 //
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
+#include <map>
+#include <utility>
+
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/styles/format.hpp>
+#include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/const_range_iterator.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 
+#include <detail/cell_impl.hpp>
+
 namespace xlnt {
 
 range::range(worksheet ws, const range_reference &reference, major_order order, bool skip_null)
@@ -92,6 +99,88 @@ bool range::contains(const cell_reference &ref)
            ref_.get_top_left().get_row() <= ref.get_row() && ref_.get_bottom_right().get_row() >= ref.get_row();
 }
 
+void range::apply_format(const std::function<void(format &)> &modify)
+{
+    apply_format(modify, false);
+}
+
+void range::apply_format(const std::function<void(format &)> &modify, bool unformatted_from_default)
+{
+    auto &wb = ws_.get_workbook();
+
+    // maps whether a cell had a format, and which one, to the id it should have afterwards
+    std::map<std::pair<bool, std::size_t>, std::uint32_t> new_format_ids;
+
+    // always visit cells in row-major order since that's how the worksheet stores them
+    const auto top_left = ref_.get_top_left();
+    const auto bottom_right = ref_.get_bottom_right();
+
+    for (auto row = top_left.get_row(); row <= bottom_right.get_row(); row++)
+    {
+        for (auto column = top_left.get_column(); column <= bottom_right.get_column(); column++)
+        {
+            auto current_cell = ws_.get_cell(cell_reference(column, row));
+            auto old_format = std::make_pair(current_cell.has_format(), current_cell.get_format_id());
+            auto match = new_format_ids.find(old_format);
+
+            if (match == new_format_ids.end())
+            {
+                auto new_format = old_format.first || !unformatted_from_default
+                    ? wb.get_format(old_format.second) : format();
+                modify(new_format);
+                auto new_format_id = static_cast<std::uint32_t>(wb.add_format(new_format));
+                match = new_format_ids.emplace(old_format, new_format_id).first;
+            }
+
+            current_cell.d_->format_id_ = match->second;
+            current_cell.d_->has_format_ = true;
+        }
+    }
+}
+
+void range::set_format(const format &new_format)
+{
+    apply_format([&new_format](format &f) { f = new_format; });
+}
+
+void range::set_number_format(const number_format &new_number_format)
+{
+    auto number_format_with_id = new_number_format;
+
+    if (!number_format_with_id.has_id())
+    {
+        number_format_with_id.set_id(ws_.next_custom_number_format_id());
+    }
+
+    // like cell::set_number_format, cells without a format start from a default one
+    apply_format([&number_format_with_id](format &f) { f.set_number_format(number_format_with_id); }, true);
+}
+
+void range::set_font(const font &new_font)
+{
+    apply_format([&new_font](format &f) { f.set_font(new_font); });
+}
+
+void range::set_fill(const fill &new_fill)
+{
+    apply_format([&new_fill](format &f) { f.set_fill(new_fill); });
+}
+
+void range::set_border(const border &new_border)
+{
+    apply_format([&new_border](format &f) { f.set_border(new_border); });
+}
+
+void range::set_alignment(const alignment &new_alignment)
+{
+    apply_format([&new_alignment](format &f) { f.set_alignment(new_alignment); });
+}
+
+void range::set_protection(const protection &new_protection)
+{
+    apply_format([&new_protection](format &f) { f.set_protection(new_protection); });
+}
+
 cell range::get_cell(const cell_reference &ref)
 {
     return (*this)[ref.get_row() - 1][ref.get_column().index - 1];
@@ -446,7 +446,72 @@ public:
         ws.auto_filter("c1:g9");
         TS_ASSERT_EQUALS(ws.get_auto_filter(), "C1:G9");
     }
-    
+
+    void test_range_set_font()
+    {
+        xlnt::workbook wb;
+        xlnt::worksheet ws(wb);
+
+        xlnt::side thin;
+        thin.get_border_style() = xlnt::border_style::thin;
+        xlnt::border border;
+        border.get_top() = thin;
+        ws.get_cell("B2").set_border(border);
+
+        xlnt::font font;
+        font.set_bold(true);
+        ws.get_range("A1:C3").set_font(font);
+
+        for (auto row : ws.get_range("A1:C3"))
+        {
+            for (auto cell : row)
+            {
+                TS_ASSERT(cell.has_format());
+                TS_ASSERT(cell.get_font().is_bold());
+            }
+        }
+
+        TS_ASSERT(ws.get_cell("B2").get_border() == border);
+        TS_ASSERT(!(ws.get_cell("A1").get_border() == border));
+        TS_ASSERT_EQUALS(&ws.get_cell("A1").get_format(), &ws.get_cell("C3").get_format());
+        TS_ASSERT_DIFFERS(&ws.get_cell("A1").get_format(), &ws.get_cell("B2").get_format());
+
+        xlnt::cell d4 = ws.get_cell("D4");
+        d4.set_border(border);
+        d4.set_font(font);
+        TS_ASSERT_EQUALS(&d4.get_format(), &ws.get_cell("B2").get_format());
+    }
+
+    void test_range_set_number_format()
+    {
+        xlnt::workbook wb;
+        xlnt::worksheet ws(wb);
+
+        // make the workbook's first format differ from a default one
+        xlnt::font bold;
+        bold.set_bold(true);
+        xlnt::format first_format;
+        first_format.set_font(bold);
+        wb.clear_formats();
+        wb.add_format(first_format);
+
+        // B2 has the first format, the others have none
+        ws.get_cell("B2").set_format(wb.get_format(0));
+
+        auto percentage = xlnt::number_format::percentage();
+        ws.get_range("A1:B2").set_number_format(percentage);
+
+        xlnt::cell d4 = ws.get_cell("D4");
+        d4.set_number_format(percentage);
+
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_number_format(), percentage);
+        TS_ASSERT_EQUALS(ws.get_cell("B2").get_number_format(), percentage);
+        TS_ASSERT(!ws.get_cell("A1").get_font().is_bold());
+        TS_ASSERT(ws.get_cell("B2").get_font().is_bold());
+        TS_ASSERT_EQUALS(&ws.get_cell("A1").get_format(), &d4.get_format());
+        TS_ASSERT_EQUALS(&ws.get_cell("A1").get_format(), &ws.get_cell("B1").get_format());
+    }
+
     void test_getitem()
     {
         xlnt::workbook wb;
@@ -1042,6 +1107,75 @@ public:
         TS_ASSERT_EQUALS(dimensions, xlnt::range_reference("B2", "B2"));
     }
 
+    void test_cells_out_of_order()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        auto first = ws.get_cell("A1");
+        first.set_value(1);
+
+        // creating many cells in reverse order mustn't invalidate existing handles
+        for (xlnt::row_t row = 100; row >= 1; row--)
+        {
+            for (xlnt::column_t::index_t column = 20; column >= 1; column--)
+            {
+                ws.get_cell(xlnt::cell_reference(column, row)).set_value(static_cast<int>(row * 100 + column));
+            }
+        }
+
+        TS_ASSERT_EQUALS(first.get_value<int>(), 101);
+        TS_ASSERT_EQUALS(ws.calculate_dimension(), xlnt::range_reference("A1:T100"));
+
+        xlnt::row_t expected_row = 1;
+
+        for (auto row : ws.rows())
+        {
+            xlnt::column_t::index_t expected_column = 1;
+
+            for (auto cell : row)
+            {
+                TS_ASSERT_EQUALS(cell.get_value<int>(), static_cast<int>(expected_row * 100 + expected_column));
+                expected_column++;
+            }
+
+            expected_row++;
+        }
+
+        for (xlnt::column_t::index_t column = 1; column <= 20; column++)
+        {
+            ws.get_cell(xlnt::cell_reference(column, 1)).clear_value();
+        }
+
+        auto kept = ws.get_cell("B2");
+        ws.garbage_collect();
+        TS_ASSERT(!ws.has_cell("A1"));
+        TS_ASSERT_EQUALS(ws.get_lowest_row(), 2);
+
+        ws.get_cell("Z1").set_value(5);
+        TS_ASSERT_EQUALS(kept.get_value<int>(), 202);
+        TS_ASSERT_EQUALS(ws.get_cell("Z1").get_value<int>(), 5);
+    }
+
+    void test_extents()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        ws.get_cell("C3").set_value(1);
+        ws.get_cell("E2").set_value(2);
+        ws.get_cell("B7").set_value(3);
+        TS_ASSERT_EQUALS(ws.calculate_dimension(), xlnt::range_reference("B2:E7"));
+
+        ws.get_cell("B7").clear_value();
+        ws.get_cell("E2").clear_value();
+        ws.garbage_collect();
+        TS_ASSERT_EQUALS(ws.calculate_dimension(), xlnt::range_reference("C3:C3"));
+
+        wb.copy_sheet(ws);
+        TS_ASSERT_EQUALS(wb.get_sheet_by_index(1).calculate_dimension(), xlnt::range_reference("C3:C3"));
+    }
+
     void test_get_title_bad()
     {
         xlnt::worksheet ws;
@@ -45,6 +45,8 @@
 #include <detail/cell_impl.hpp>
 #include <detail/constants.hpp>
 #include <detail/workbook_impl.hpp>
+#include <detail/worksheet_row_reader.hpp>
+#include <detail/worksheet_row_writer.hpp>
 #include <detail/worksheet_impl.hpp>
 
 namespace xlnt {
@@ -113,6 +115,7 @@ std::vector<range_reference> worksheet::get_merged_ranges() const
 
 page_margins &worksheet::get_page_margins()
 {
+    d_->unmodified_part_.clear();
     return d_->page_margins_;
 }
 
@@ -128,6 +131,7 @@ void worksheet::auto_filter(const std::string &reference_string)
 
 void worksheet::auto_filter(const range_reference &reference)
 {
+    d_->unmodified_part_.clear();
     d_->auto_filter_ = reference;
 }
 
@@ -148,11 +152,13 @@ bool worksheet::has_auto_filter() const
 
 void worksheet::unset_auto_filter()
 {
+    d_->unmodified_part_.clear();
     d_->auto_filter_ = range_reference(1, 1, 1, 1);
 }
 
 page_setup &worksheet::get_page_setup()
 {
+    d_->unmodified_part_.clear();
     return d_->page_setup_;
 }
 
@@ -178,33 +184,8 @@ const workbook &worksheet::get_workbook() const
 
 void worksheet::garbage_collect()
 {
-    auto cell_map_iter = d_->cell_map_.begin();
-
-    while (cell_map_iter != d_->cell_map_.end())
-    {
-        auto cell_iter = cell_map_iter->second.begin();
-
-        while (cell_iter != cell_map_iter->second.end())
-        {
-            cell current_cell(&cell_iter->second);
-
-            if (current_cell.garbage_collectible())
-            {
-                cell_iter = cell_map_iter->second.erase(cell_iter);
-                continue;
-            }
-
-            cell_iter++;
-        }
-
-        if (cell_map_iter->second.empty())
-        {
-            cell_map_iter = d_->cell_map_.erase(cell_map_iter);
-            continue;
-        }
-
-        cell_map_iter++;
-    }
+    d_->unmodified_part_.clear();
+    d_->cells_.erase_if([](detail::cell_impl &c) { return c.self().garbage_collectible(); });
 }
 
 std::string worksheet::get_title() const
@@ -233,6 +214,8 @@ void worksheet::freeze_panes(xlnt::cell top_left_cell)
 
 void worksheet::freeze_panes(const std::string &top_left_coordinate)
 {
+    d_->unmodified_part_.clear();
+
     auto ref = cell_reference(top_left_coordinate);
     d_->view_.get_pane().top_left_cell = ref;
     d_->view_.get_pane().state = pane_state::frozen;
@@ -274,43 +257,75 @@ void worksheet::freeze_panes(const std::string &top_left_coordinate)
 
 void worksheet::unfreeze_panes()
 {
+    d_->unmodified_part_.clear();
+
     d_->view_.get_pane().top_left_cell = cell_reference("A1");
     d_->view_.get_pane().state = pane_state::normal;
 }
 
-cell worksheet::get_cell(const cell_reference &reference)
+detail::worksheet_row_reader *worksheet::get_row_reader() const
+{
+    if (d_->source_part_.empty())
+    {
+        return nullptr;
+    }
+
+    if (!d_->row_reader_)
+    {
+        auto &wb = *d_->parent_->d_;
+        d_->row_reader_.reset(new detail::worksheet_row_reader(*this, d_, *wb.archive_, d_->source_part_, wb.stylesheet_));
+    }
+
+    return d_->row_reader_.get();
+}
+
+detail::worksheet_row_writer *worksheet::get_row_writer() const
 {
-    if (d_->cell_map_.find(reference.get_row()) == d_->cell_map_.end())
+    if (!d_->row_writer_ && d_->parent_->get_optimized_write())
     {
-        d_->cell_map_[reference.get_row()] = std::unordered_map<column_t, detail::cell_impl>();
+        d_->row_writer_ = std::make_shared<detail::worksheet_row_writer>(d_->parent_->get_compression_level());
     }
 
-    auto &row = d_->cell_map_[reference.get_row()];
+    return d_->row_writer_.get();
+}
 
-    if (row.find(reference.get_column_index()) == row.end())
+cell worksheet::get_cell(const cell_reference &reference)
+{
+    d_->unmodified_part_.clear();
+
+    if (auto reader = get_row_reader())
     {
-        row[reference.get_column_index()] = detail::cell_impl(d_, reference.get_column_index(), reference.get_row());
+        return cell(reader->get_cell(reference));
     }
 
-    return cell(&row[reference.get_column_index()]);
+    return cell(&d_->cells_.get(d_, reference.get_row(), reference.get_column_index()));
 }
 
 const cell worksheet::get_cell(const cell_reference &reference) const
 {
-    return cell(&d_->cell_map_.at(reference.get_row()).at(reference.get_column_index()));
+    if (auto reader = get_row_reader())
+    {
+        return cell(reader->get_cell(reference));
+    }
+
+    auto match = d_->cells_.find(reference.get_row(), reference.get_column_index());
+
+    if (match == nullptr)
+    {
+        throw std::out_of_range("cell doesn't exist");
+    }
+
+    return cell(match);
 }
 
 bool worksheet::has_cell(const cell_reference &reference) const
 {
-    const auto row = d_->cell_map_.find(reference.get_row());
-    if(row == d_->cell_map_.cend())
-        return false;
-    
-    const auto col = row->second.find(reference.get_column_index());
-    if(col == row->second.cend())
-        return false;
-    
-    return true;
+    if (auto reader = get_row_reader())
+    {
+        return reader->has_cell(reference);
+    }
+
+    return d_->cells_.find(reference.get_row(), reference.get_column_index()) != nullptr;
 }
 
 bool worksheet::has_row_properties(row_t row) const
@@ -335,70 +350,71 @@ range worksheet::get_named_range(const std::string &name)
 
 column_t worksheet::get_lowest_column() const
 {
-    if (d_->cell_map_.empty())
+    if (auto reader = get_row_reader())
     {
-        return constants::min_column();
+        return reader->get_dimension().get_top_left().get_column_index();
     }
 
-    column_t lowest = constants::max_column();
-
-    for (auto &row : d_->cell_map_)
+    if (d_->cells_.empty())
     {
-        for (auto &c : row.second)
-        {
-            lowest = std::min(lowest, c.first);
-        }
+        return constants::min_column();
     }
 
-    return lowest;
+    return d_->cells_.lowest_column();
 }
 
 row_t worksheet::get_lowest_row() const
 {
-    if (d_->cell_map_.empty())
+    if (auto reader = get_row_reader())
     {
-        return constants::min_row();
+        return reader->get_dimension().get_top_left().get_row();
     }
 
-    row_t lowest = constants::max_row();
-
-    for (auto &row : d_->cell_map_)
+    if (d_->cells_.empty())
     {
-        lowest = std::min(lowest, row.first);
+        return constants::min_row();
     }
 
-    return lowest;
+    return d_->cells_.begin()->index;
 }
 
 row_t worksheet::get_highest_row() const
 {
-    row_t highest = constants::min_row();
+    if (auto reader = get_row_reader())
+    {
+        return reader->get_dimension().get_bottom_right().get_row();
+    }
 
-    for (auto &row : d_->cell_map_)
+    if (d_->cells_.empty())
     {
-        highest = std::max(highest, row.first);
+        return constants::min_row();
     }
 
-    return highest;
+    return std::max(constants::min_row(), (d_->cells_.end() - 1)->index);
 }
 
 column_t worksheet::get_highest_column() const
 {
-    column_t highest = constants::min_column();
+    if (auto reader = get_row_reader())
+    {
+        return reader->get_dimension().get_bottom_right().get_column_index();
+    }
 
-    for (auto &row : d_->cell_map_)
+    if (d_->cells_.empty())
     {
-        for (auto &c : row.second)
-        {
-            highest = std::max(highest, c.first);
-        }
+        return constants::min_column();
     }
 
-    return highest;
+    return d_->cells_.highest_column();
 }
 
 range_reference worksheet::calculate_dimension() const
 {
+    if (auto reader = get_row_reader())
+    {
+        return reader->get_dimension();
+    }
+
     auto lowest_column = get_lowest_column();
     auto lowest_row = get_lowest_row();
 
@@ -447,6 +463,8 @@ const std::vector<relationship> &worksheet::get_relationships() const
 
 relationship worksheet::create_relationship(relationship::type type, const std::string &target_uri)
 {
+    d_->unmodified_part_.clear();
+
     std::string r_id = "rId" + std::to_string(d_->relationships_.size() + 1);
     d_->relationships_.push_back(relationship(type, r_id, target_uri));
     return d_->relationships_.back();
@@ -464,6 +482,8 @@ void worksheet::unmerge_cells(const std::string &reference_string)
 
 void worksheet::merge_cells(const range_reference &reference)
 {
+    d_->unmodified_part_.clear();
+
     d_->merged_cells_.push_back(reference);
     bool first = true;
 
@@ -497,6 +517,8 @@ void worksheet::merge_cells(column_t start_column, row_t start_row, column_t end
 
 void worksheet::unmerge_cells(const range_reference &reference)
 {
+    d_->unmodified_part_.clear();
+
     auto match = std::find(d_->merged_cells_.begin(), d_->merged_cells_.end(), reference);
 
     if (match == d_->merged_cells_.end())
@@ -522,12 +544,12 @@ void worksheet::unmerge_cells(column_t start_column, row_t start_row, column_t e
 
 void worksheet::append()
 {
-    get_cell(cell_reference(1, get_next_row()));
+    get_cell(cell_reference(1, prepare_append()));
 }
 
 void worksheet::append(const std::vector<std::string> &cells)
 {
-    xlnt::cell_reference next(1, get_next_row());
+    xlnt::cell_reference next(1, prepare_append());
 
     for (auto cell : cells)
     {
@@ -538,9 +560,14 @@ void worksheet::append(const std::vector<std::string> &cells)
 
 row_t worksheet::get_next_row() const
 {
+    if (auto writer = get_row_writer())
+    {
+        return d_->cells_.empty() ? writer->get_next_row() : get_highest_row() + 1;
+    }
+
     auto row = get_highest_row() + 1;
 
-    if (row == 2 && d_->cell_map_.size() == 0)
+    if (row == 2 && d_->cells_.empty())
     {
         row = 1;
     }
@@ -548,9 +575,19 @@ row_t worksheet::get_next_row() const
     return row;
 }
 
+row_t worksheet::prepare_append()
+{
+    if (auto writer = get_row_writer())
+    {
+        writer->write_rows(*this);
+    }
+
+    return get_next_row();
+}
+
 void worksheet::append(const std::vector<int> &cells)
 {
-    xlnt::cell_reference next(1, get_next_row());
+    xlnt::cell_reference next(1, prepare_append());
 
     for (auto cell : cells)
     {
@@ -561,7 +598,7 @@ void worksheet::append(const std::vector<int> &cells)
 
 void worksheet::append(const std::unordered_map<std::string, std::string> &cells)
 {
-    auto row = get_next_row();
+    auto row = prepare_append();
 
     for (auto cell : cells)
     {
@@ -571,7 +608,7 @@ void worksheet::append(const std::unordered_map<std::string, std::string> &cells
 
 void worksheet::append(const std::unordered_map<int, std::string> &cells)
 {
-    auto row = get_next_row();
+    auto row = prepare_append();
 
     for (auto cell : cells)
     {
@@ -581,7 +618,7 @@ void worksheet::append(const std::unordered_map<int, std::string> &cells)
 
 void worksheet::append(const std::vector<int>::const_iterator begin, const std::vector<int>::const_iterator end)
 {
-    xlnt::cell_reference next(1, get_next_row());
+    xlnt::cell_reference next(1, prepare_append());
 
     for (auto i = begin; i != end; i++)
     {
@@ -631,22 +668,24 @@ bool worksheet::compare(const worksheet &other, bool reference) const
     
     if(d_->parent_ != other.d_->parent_) return false;
     
-    for(auto &row : d_->cell_map_)
+    for(auto &row : d_->cells_)
     {
-        if(other.d_->cell_map_.find(row.first) == other.d_->cell_map_.end())
+        if(other.d_->cells_.find_row(row.index) == nullptr)
         {
             return false;
         }
         
-        for(auto &cell : row.second)
+        for(auto cell : row.cells)
         {
-            if(other.d_->cell_map_[row.first].find(cell.first) == other.d_->cell_map_[row.first].end())
+            auto other_impl = other.d_->cells_.find(row.index, cell->column_);
+
+            if(other_impl == nullptr)
             {
                 return false;
             }
             
-            auto this_cell = cell.second.self();
-            auto other_cell = other.d_->cell_map_[row.first][cell.first].self();
+            auto this_cell = cell->self();
+            auto other_cell = other_impl->self();
 
             if (this_cell.get_data_type() != other_cell.get_data_type())
             {
@@ -730,16 +769,18 @@ void worksheet::remove_named_range(const std::string &name)
 
 void worksheet::reserve(std::size_t n)
 {
-    d_->cell_map_.reserve(n);
+    d_->cells_.reserve(n);
 }
 
 void worksheet::increment_comments()
 {
+    d_->unmodified_part_.clear();
     d_->comment_count_++;
 }
 
 void worksheet::decrement_comments()
 {
+    d_->unmodified_part_.clear();
     d_->comment_count_--;
 }
 
@@ -750,6 +791,7 @@ std::size_t worksheet::get_comment_count() const
 
 header_footer &worksheet::get_header_footer()
 {
+    d_->unmodified_part_.clear();
     return d_->header_footer_;
 }
 
@@ -845,11 +887,13 @@ cell_reference worksheet::get_point_pos(const std::pair<int, int> &point) const
 
 void worksheet::set_sheet_state(sheet_state state)
 {
+    d_->unmodified_part_.clear();
     get_page_setup().set_sheet_state(state);
 }
 
 void worksheet::add_column_properties(column_t column, const xlnt::column_properties &props)
 {
+    d_->unmodified_part_.clear();
     d_->column_properties_[column] = props;
 }
 
@@ -860,6 +904,7 @@ bool worksheet::has_column_properties(column_t column) const
 
 column_properties &worksheet::get_column_properties(column_t column)
 {
+    d_->unmodified_part_.clear();
     return d_->column_properties_[column];
 }
 
@@ -870,6 +915,7 @@ const column_properties &worksheet::get_column_properties(column_t column) const
 
 row_properties &worksheet::get_row_properties(row_t row)
 {
+    d_->unmodified_part_.clear();
     return d_->row_properties_[row];
 }
 
@@ -938,6 +984,8 @@ void worksheet::add_print_title(int i)
 
 void worksheet::add_print_title(int i, const std::string &rows_or_cols)
 {
+    d_->unmodified_part_.clear();
+
     if(rows_or_cols == "cols")
     {
         set_print_title_cols("A:" + column_t::column_string_from_index(i));
@@ -950,11 +998,13 @@ void worksheet::add_print_title(int i, const std::string &rows_or_cols)
 
 void worksheet::set_print_title_rows(const std::string &rows)
 {
+    d_->unmodified_part_.clear();
     d_->print_title_rows_ = rows;
 }
 
 void worksheet::set_print_title_cols(const std::string &cols)
 {
+    d_->unmodified_part_.clear();
     d_->print_title_cols_ = cols;
 }
 
@@ -976,6 +1026,7 @@ std::string worksheet::get_print_titles() const
 
 void worksheet::set_print_area(const std::string &print_area)
 {
+    d_->unmodified_part_.clear();
     d_->print_area_ = range_reference::make_absolute(range_reference(print_area));
 }
 